@@ -43,6 +43,13 @@ void setup()
     errorHandler("Begin");
     return;
   }
+  // Select the fastest reliable bus clock
+  if (sensor.isError(sensor.probeBusClock()))
+  {
+    errorHandler("Bus clock");
+  }
+  Serial.print("Bus clock (Hz): ");
+  Serial.println(sensor.getBusClock());
   if (sensor.isError(sensor.setResolutionTemp12()))
   {
     errorHandler("Resolution");
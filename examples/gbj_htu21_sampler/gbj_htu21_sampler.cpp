@@ -0,0 +1,75 @@
+/*
+  NAME:
+  Periodic measurement with gbjHTU21Sampler library.
+
+  DESCRIPTION:
+  The sketch measures humidity and temperature with HTU21D(F) sensor at evenly
+  spaced deadlines without drifting by conversion times and displays jitter
+  statistics.
+  - Connect sensor's pins to microcontroller's I2C bus as described in README.md
+  for used platform accordingly.
+
+  LICENSE:
+  This program is free software; you can redistribute it and/or modify it under
+  the terms of the MIT License (MIT).
+
+  CREDENTIALS:
+  Author: Libor Gabaj
+*/
+#include "gbj_htu21.h"
+#include "gbj_htu21_sampler.h"
+
+// Time in miliseconds between deadlines of measurements
+const unsigned int PERIOD_MEASURE = 3000;
+
+gbj_htu21 sensor = gbj_htu21();
+gbj_htu21_sampler sampler = gbj_htu21_sampler(sensor);
+
+void errorHandler(String location)
+{
+  Serial.println(sensor.getLastErrorTxt(location));
+  Serial.println("---");
+  return;
+}
+
+void setup()
+{
+  Serial.begin(9600);
+  Serial.println("---");
+
+  // Initialize sensor - default holdMasterMode
+  if (sensor.isError(sensor.begin()))
+  {
+    errorHandler("Begin");
+    return;
+  }
+  if (sensor.isError(sampler.begin(PERIOD_MEASURE)))
+  {
+    errorHandler("Period");
+  }
+  Serial.println("Deadline (ms) / Humidity (%) / Temperature (°C) / "
+                 "Jitter min/max (ms) / Missed");
+}
+
+void loop()
+{
+  unsigned long failures = sampler.getFailures();
+  if (sampler.run())
+  {
+    Serial.print(sampler.getTimestamp());
+    Serial.print(" / ");
+    Serial.print(sampler.getHumidity());
+    Serial.print(" / ");
+    Serial.print(sampler.getTemperature());
+    Serial.print(" / ");
+    Serial.print(sampler.getJitterMin());
+    Serial.print("/");
+    Serial.print(sampler.getJitterMax());
+    Serial.print(" / ");
+    Serial.println(sampler.getMissed());
+  }
+  else if (sampler.getFailures() != failures)
+  {
+    errorHandler("Measurement");
+  }
+}
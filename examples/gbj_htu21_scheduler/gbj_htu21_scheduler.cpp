@@ -0,0 +1,77 @@
+/*
+  NAME:
+  Power-aware measurement with gbjHTU21Scheduler library.
+
+  DESCRIPTION:
+  The sketch measures humidity and temperature with HTU21D(F) sensor in the
+  configuration selected by the scheduler for the energy budget and displays
+  the estimated energy accounting.
+  - Connect sensor's pins to microcontroller's I2C bus as described in README.md
+  for used platform accordingly.
+
+  LICENSE:
+  This program is free software; you can redistribute it and/or modify it under
+  the terms of the MIT License (MIT).
+
+  CREDENTIALS:
+  Author: Libor Gabaj
+*/
+#include "gbj_htu21.h"
+#include "gbj_htu21_scheduler.h"
+
+// Time in miliseconds between measurements
+const unsigned int PERIOD_MEASURE = 3000;
+// Charge budget per measurement in nanocoulombs
+const unsigned long BUDGET_MEASURE = 30000;
+
+gbj_htu21 sensor = gbj_htu21();
+gbj_htu21_scheduler scheduler = gbj_htu21_scheduler(sensor);
+
+void errorHandler(String location)
+{
+  Serial.println(sensor.getLastErrorTxt(location));
+  Serial.println("---");
+  return;
+}
+
+void setup()
+{
+  Serial.begin(9600);
+  Serial.println("---");
+
+  // Initialize sensor - default holdMasterMode
+  if (sensor.isError(sensor.begin()))
+  {
+    errorHandler("Begin");
+    return;
+  }
+  if (sensor.isError(scheduler.begin(PERIOD_MEASURE, BUDGET_MEASURE)))
+  {
+    errorHandler("Budget");
+  }
+  Serial.print("Temperature Resolution: ");
+  Serial.print(sensor.getResolutionTemp());
+  Serial.println(" bits");
+  Serial.print("Hold Master Mode: ");
+  Serial.println(sensor.getHoldMasterMode() ? "Yes" : "No");
+  Serial.print("Charge per sample (nC): ");
+  Serial.println(scheduler.getChargeSample());
+  Serial.println("Humidity (%) / Temperature (°C) / Duty cycle (0.01%)");
+}
+
+void loop()
+{
+  unsigned long samples = scheduler.getSamples();
+  if (scheduler.run())
+  {
+    Serial.print(scheduler.getHumidity());
+    Serial.print(" / ");
+    Serial.print(scheduler.getTemperature());
+    Serial.print(" / ");
+    Serial.println(scheduler.getDutyCycle());
+  }
+  else if (scheduler.getSamples() != samples)
+  {
+    errorHandler("Measurement");
+  }
+}
@@ -0,0 +1,54 @@
+/*
+  NAME:
+  Binary streaming of measurements with gbjHTU21Stream library.
+
+  DESCRIPTION:
+  The sketch measures humidity and temperature with HTU21D(F) sensor and writes
+  each sample to the serial port as a binary frame instead of formatted floating
+  point numbers.
+  - Connect sensor's pins to microcontroller's I2C bus as described in README.md
+  for used platform accordingly.
+  - Convert captured stream to CSV with the host program in the folder
+  extras/gbj_htu21_decode.
+
+  LICENSE:
+  This program is free software; you can redistribute it and/or modify it under
+  the terms of the MIT License (MIT).
+
+  CREDENTIALS:
+  Author: Libor Gabaj
+*/
+#include "gbj_htu21.h"
+#include "gbj_htu21_stream.h"
+
+// Time in miliseconds between measurements
+const unsigned int PERIOD_MEASURE = 100;
+
+gbj_htu21 sensor = gbj_htu21();
+// gbj_htu21 sensor = gbj_htu21(sensor.CLOCK_400KHZ);
+gbj_htu21_stream stream = gbj_htu21_stream(sensor);
+
+uint8_t frame[gbj_htu21_stream::FRAME_SIZE];
+float tempValue, rhumValue;
+
+void setup()
+{
+  Serial.begin(115200);
+  // Initialize sensor - default holdMasterMode
+  if (sensor.isError(sensor.begin()))
+  {
+    return;
+  }
+  sensor.setResolutionTemp12();
+  stream.begin();
+}
+
+void loop()
+{
+  rhumValue = sensor.measureHumidity(tempValue);
+  if (sensor.isSuccess())
+  {
+    Serial.write(frame, stream.encode(frame, sizeof(frame)));
+  }
+  delay(PERIOD_MEASURE);
+}
@@ -0,0 +1,113 @@
+/*
+  NAME:
+  Host demonstration of non-blocking initialization of gbjHTU21 library.
+
+  DESCRIPTION:
+  The program initializes a number of emulated sensors, each on its own bus,
+  first one by one with blocking begin() and then with beginAsync() and
+  service() called in one loop, and reports both in virtual time.
+  - Timeline CSV records of bus transactions of the non-blocking
+  initialization are written to the standard output:
+    time_ms,sensor,transaction
+  - Summary of both initializations is written to the standard error.
+  - Options:
+    -n <sensors> - Number of sensors, default 4.
+  - Build on a host computer with all source files of the library from the
+  folder ../../src:
+    g++ -O2 -std=c++11 -I../host -I../../src -o gbj_htu21_begin
+      gbj_htu21_begin.cpp ../host/gbj_twowire.cpp ../host/gbj_htu21_emulated.cpp
+      ../../src/gbj_htu21.cpp ...
+
+  LICENSE:
+  This program is free software; you can redistribute it and/or modify it under
+  the terms of the MIT License (MIT).
+
+  CREDENTIALS:
+  Author: Libor Gabaj
+*/
+#include "gbj_htu21.h"
+#include "gbj_htu21_emulated.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+int main(int argc, char *argv[])
+{
+  unsigned count = 4;
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+    {
+      count = atoi(argv[++i]);
+    }
+    else
+    {
+      fprintf(stderr, "Usage: %s [-n sensors]\n", argv[0]);
+      return 1;
+    }
+  }
+  std::vector<gbj_htu21_emulated *> buses;
+  std::vector<gbj_htu21 *> sensors;
+  for (unsigned i = 0; i < count; i++)
+  {
+    buses.push_back(new gbj_htu21_emulated(i));
+    sensors.push_back(new gbj_htu21());
+    sensors[i]->setTransport(buses[i]);
+  }
+
+  // Blocking initialization one by one
+  unsigned long timeStart = millis();
+  unsigned failures = 0;
+  for (unsigned i = 0; i < count; i++)
+  {
+    if (sensors[i]->isError(sensors[i]->begin()))
+    {
+      failures++;
+    }
+  }
+  unsigned long timeBlocking = millis() - timeStart;
+  fprintf(stderr,
+          "Blocking: %u sensors, %lu ms, %u failures\n",
+          count,
+          timeBlocking,
+          failures);
+
+  // Non-blocking initialization of all sensors in one loop
+  printf("time_ms,sensor,transaction\n");
+  timeStart = millis();
+  failures = 0;
+  for (unsigned i = 0; i < count; i++)
+  {
+    buses[i]->setLogging(true);
+    sensors[i]->beginAsync();
+  }
+  bool pending = true;
+  while (pending)
+  {
+    pending = false;
+    for (unsigned i = 0; i < count; i++)
+    {
+      pending |= sensors[i]->service();
+    }
+    if (pending)
+    {
+      delay(1);
+    }
+  }
+  for (unsigned i = 0; i < count; i++)
+  {
+    failures += sensors[i]->isError() ? 1 : 0;
+  }
+  fprintf(stderr,
+          "Non-blocking: %u sensors, %lu ms, %u failures\n",
+          count,
+          millis() - timeStart,
+          failures);
+  for (unsigned i = 0; i < count; i++)
+  {
+    delete sensors[i];
+    delete buses[i];
+  }
+  return 0;
+}
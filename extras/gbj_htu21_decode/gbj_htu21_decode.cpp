@@ -0,0 +1,139 @@
+/*
+  NAME:
+  Host decoder of binary frames streamed by gbjHTU21Stream library.
+
+  DESCRIPTION:
+  The program converts captured binary streams of frames encoded by the class
+  gbj_htu21_stream to CSV records on the standard output.
+  - The program reads files provided as arguments or the standard input.
+  - Frames with wrong CRC are skipped and the decoder resynchronizes on the
+  next synchronization byte.
+  - The count of decoded and skipped frames is reported to the standard error.
+  - Build on a host computer:
+    g++ -O2 -std=c++11 -o gbj_htu21_decode gbj_htu21_decode.cpp
+
+  LICENSE:
+  This program is free software; you can redistribute it and/or modify it under
+  the terms of the MIT License (MIT).
+
+  CREDENTIALS:
+  Author: Libor Gabaj
+*/
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// Frame layout of the class gbj_htu21_stream
+const uint8_t FRAME_SYNC = 0xA5;
+const size_t FRAME_SIZE = 17;
+const uint8_t FRAME_STALE = 0x80;
+// Size of the input chunk in bytes
+const size_t CHUNK_SIZE = 1 << 16;
+
+uint8_t calculateCrc8(const uint8_t *byteArray, size_t byteCnt)
+{
+  uint8_t crc = 0;
+  for (size_t i = 0; i < byteCnt; i++)
+  {
+    crc ^= byteArray[i];
+    for (int8_t b = 7; b >= 0; b--)
+    {
+      crc = (crc & 0x80) ? (crc << 1) ^ 0x31 : (crc << 1);
+    }
+  }
+  return crc;
+}
+
+inline uint16_t readWord(const uint8_t *data)
+{
+  return (data[0] << 8) | data[1];
+}
+
+// Decode all complete frames and return the number of consumed bytes
+size_t decode(const uint8_t *data,
+              size_t dataLen,
+              unsigned long &frames,
+              unsigned long &skipped)
+{
+  size_t idx = 0;
+  while (idx + FRAME_SIZE <= dataLen)
+  {
+    const uint8_t *frame = data + idx;
+    if (frame[0] != FRAME_SYNC ||
+        calculateCrc8(frame, FRAME_SIZE - 1) != frame[FRAME_SIZE - 1])
+    {
+      if (frame[0] == FRAME_SYNC)
+      {
+        skipped++;
+      }
+      idx++;
+      continue;
+    }
+    uint64_t serial = 0;
+    for (uint8_t i = 1; i <= 8; i++)
+    {
+      serial = (serial << 8) | frame[i];
+    }
+    uint16_t sequence = readWord(&frame[9]);
+    uint16_t wordTemp = readWord(&frame[11]);
+    uint16_t wordRhum = readWord(&frame[13]);
+    uint8_t code = frame[15];
+    double temperature = wordTemp * 175.72 / 65536.0 - 46.85;
+    double humidity = wordRhum * 125.0 / 65536.0 - 6.0;
+    printf("%016" PRIx64 ",%u,%u,%u,%u,%u,%.2f,%.2f\n",
+           serial,
+           sequence,
+           code & 0x03,
+           (code & FRAME_STALE) ? 1 : 0,
+           wordTemp,
+           wordRhum,
+           temperature,
+           humidity);
+    frames++;
+    idx += FRAME_SIZE;
+  }
+  return idx;
+}
+
+void decodeFile(FILE *file, unsigned long &frames, unsigned long &skipped)
+{
+  static uint8_t data[CHUNK_SIZE + FRAME_SIZE];
+  size_t dataLen = 0;
+  size_t readLen;
+  while ((readLen = fread(data + dataLen, 1, CHUNK_SIZE, file)) > 0)
+  {
+    dataLen += readLen;
+    size_t consumed = decode(data, dataLen, frames, skipped);
+    // Keep incomplete frame for the next chunk
+    memmove(data, data + consumed, dataLen - consumed);
+    dataLen -= consumed;
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  static char output[CHUNK_SIZE];
+  setvbuf(stdout, output, _IOFBF, sizeof(output));
+  unsigned long frames = 0, skipped = 0;
+  printf("serial,sequence,resolution,stale,word_temp,word_rhum,temperature,"
+         "humidity\n");
+  if (argc < 2)
+  {
+    decodeFile(stdin, frames, skipped);
+  }
+  for (int i = 1; i < argc; i++)
+  {
+    FILE *file = fopen(argv[i], "rb");
+    if (file == NULL)
+    {
+      fprintf(stderr, "Cannot open %s\n", argv[i]);
+      return 1;
+    }
+    decodeFile(file, frames, skipped);
+    fclose(file);
+  }
+  fflush(stdout);
+  fprintf(stderr, "Frames: %lu, skipped: %lu\n", frames, skipped);
+  return 0;
+}
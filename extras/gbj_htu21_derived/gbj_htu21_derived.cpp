@@ -0,0 +1,157 @@
+/*
+  NAME:
+  Host check of derived quantities of gbjHTU21 library.
+
+  DESCRIPTION:
+  The program compares dew point, absolute humidity, and heat index calculated
+  by the library in integer arithmetic with floating point reference formulas
+  over the whole range of temperature and relative humidity and checks them
+  against documented error bounds.
+  - Dew point by Magnus formula with b = 17.62 and c = 243.12 centigrades,
+  absolute error up to 0.11 centigrade for relative humidity above 5 %.
+  - Absolute humidity from saturation vapour pressure by Magnus formula,
+  relative error up to 0.3 % for absolute humidity above 5 g/m3.
+  - Heat index by NOAA algorithm (Steadman's formula and Rothfusz regression
+  without adjustments), absolute error up to 0.4 centigrade for temperature
+  up to 40 centigrades. The vicinity of switching from Steadman's formula to
+  Rothfusz regression is skipped, because the formulas are discontinuous
+  there.
+  - Option -s sets the step of temperature and humidity sweep in 0.01 units,
+  default 10.
+  - The program writes the maximal errors with the worst inputs and exits
+  with nonzero status, if any bound is exceeded.
+  - Build on a host computer with all source files of the library from the
+  folder ../../src:
+    g++ -O2 -std=c++11 -I../host -I../../src -o gbj_htu21_derived
+      gbj_htu21_derived.cpp ../host/gbj_twowire.cpp ../../src/gbj_htu21.cpp ...
+
+  LICENSE:
+  This program is free software; you can redistribute it and/or modify it under
+  the terms of the MIT License (MIT).
+
+  CREDENTIALS:
+  Author: Libor Gabaj
+*/
+#include "gbj_htu21.h"
+#include <cmath>
+#include <cstdio>
+
+struct Bound
+{
+  const char *name;
+  const char *unit;
+  double limit;
+  double error;
+  double temperature;
+  double humidity;
+};
+
+double refDewPoint(double t, double rh)
+{
+  double gamma = log(rh / 100.0) + 17.62 * t / (243.12 + t);
+  return 243.12 * gamma / (17.62 - gamma);
+}
+
+double refAbsHumidity(double t, double rh)
+{
+  return 216.74 * 6.112 * exp(17.62 * t / (243.12 + t)) * rh / 100.0 /
+         (273.15 + t);
+}
+
+double refHeatIndex(double t, double rh, double &margin)
+{
+  double f = t * 9.0 / 5.0 + 32.0;
+  double index = 0.5 * (f + 61.0 + (f - 68.0) * 1.2 + rh * 0.094);
+  // Distance from switching to Rothfusz regression in Fahrenheit
+  margin = fabs((index + f) / 2.0 - 80.0);
+  if ((index + f) / 2.0 >= 80.0)
+  {
+    index = -42.379 + 2.04901523 * f + 10.14333127 * rh -
+            0.22475541 * f * rh - 0.00683783 * f * f -
+            0.05481717 * rh * rh + 0.00122874 * f * f * rh +
+            0.00085282 * f * rh * rh - 0.00000199 * f * f * rh * rh;
+  }
+  return (index - 32.0) * 5.0 / 9.0;
+}
+
+void account(Bound &bound, double error, double t, double rh)
+{
+  if (fabs(error) > fabs(bound.error))
+  {
+    bound.error = error;
+    bound.temperature = t;
+    bound.humidity = rh;
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  int step = 10;
+  if (argc == 3 && std::string(argv[1]) == "-s")
+  {
+    step = atoi(argv[2]);
+  }
+  if (step <= 0)
+  {
+    fprintf(stderr, "Usage: %s [-s step]\n", argv[0]);
+    return 1;
+  }
+  gbj_htu21 sensor;
+  Bound bounds[] = {
+    { "dew_point", "C", 0.11, 0, 0, 0 },
+    { "abs_humidity", "%", 0.3, 0, 0, 0 },
+    { "heat_index", "C", 0.4, 0, 0, 0 },
+  };
+  for (int ct = -4000; ct <= 12500; ct += step)
+  {
+    for (int ch = 0; ch <= 10000; ch += step)
+    {
+      // Reference at exact centi-units, library inputs nudged away from zero
+      // against truncation by conversion to centi-units
+      double t = ct / 100.0;
+      double rh = ch / 100.0;
+      double tIn = t + (ct < 0 ? -1e-5 : 1e-5);
+      double rhIn = rh + 1e-5;
+      if (rh > 5.0)
+      {
+        account(bounds[0],
+                sensor.calculateDewPoint(tIn, rhIn) - refDewPoint(t, rh),
+                t,
+                rh);
+      }
+      double ref = refAbsHumidity(t, rh);
+      if (ref > 5.0)
+      {
+        account(bounds[1],
+                (sensor.calculateAbsHumidity(tIn, rhIn) - ref) / ref * 100.0,
+                t,
+                rh);
+      }
+      // Formulas switch discontinuously, so that the vicinity is skipped
+      double margin;
+      ref = refHeatIndex(t, rh, margin);
+      if (t <= 40.0 && margin >= 0.2)
+      {
+        account(bounds[2],
+                sensor.calculateHeatIndex(tIn, rhIn) - ref,
+                t,
+                rh);
+      }
+    }
+  }
+  bool valid = true;
+  printf("quantity,max_error,unit,limit,temperature,humidity\n");
+  for (size_t i = 0; i < sizeof(bounds) / sizeof(bounds[0]); i++)
+  {
+    const Bound &b = bounds[i];
+    printf("%s,%.4f,%s,%.2f,%.2f,%.2f\n",
+           b.name,
+           b.error,
+           b.unit,
+           b.limit,
+           b.temperature,
+           b.humidity);
+    valid = valid && fabs(b.error) <= b.limit;
+  }
+  return valid ? 0 : 2;
+}
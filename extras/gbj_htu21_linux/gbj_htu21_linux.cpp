@@ -0,0 +1,223 @@
+/*
+  NAME:
+  Measurement with gbjHTU21 library on a Linux computer.
+
+  DESCRIPTION:
+  The program measures temperature and relative humidity with sensors
+  connected to two-wire buses of a Linux computer, e.g., a single board
+  computer gateway, through the userspace devices /dev/i2c-N.
+  - The library is compiled against host emulations of the Arduino core and
+  the library gbjTwoWire with the Linux i2c-dev transport in real time.
+  - Each sensor needs its own bus due to its fixed address. Multiple sensors
+  are measured in parallel by the class gbj_htu21_group of the host emulation,
+  each instance with its own transport.
+  - CSV records are written to the standard output:
+    time_ms,sensor,temperature,humidity,result
+  - The serial numbers and the number of transfers (system calls) per sample
+  are reported to the standard error.
+  - Options:
+    -n <samples> - Number of samples, default 10.
+    -p <period> - Sampling period in milliseconds, default 1000.
+    -m - No hold master mode, default hold master mode. Multiple sensors are
+    always measured in no hold master mode.
+    -x - No clock stretching by the bus adapter, i.e., separate transfers
+    with waiting in hold master mode.
+    -f - Userspace fakes of sensors instead of devices for testing on
+    a computer without sensors.
+    -c <count> - Number of fake sensors, default 1.
+  - Build on a Linux computer with all source files of the library from the
+  folder ../../src:
+    g++ -O2 -std=c++11 -I../host -I../../src -o gbj_htu21_linux
+      gbj_htu21_linux.cpp ../host/gbj_twowire.cpp ../host/gbj_twowire_linux.cpp
+      ../host/gbj_htu21_group.cpp ../host/gbj_htu21_emulated.cpp
+      ../../src/gbj_htu21.cpp ...
+
+  LICENSE:
+  This program is free software; you can redistribute it and/or modify it under
+  the terms of the MIT License (MIT).
+
+  CREDENTIALS:
+  Author: Libor Gabaj
+*/
+#include "gbj_htu21.h"
+#include "gbj_htu21_emulated.h"
+#include "gbj_htu21_group.h"
+#include "gbj_twowire_linux.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+/*
+  Userspace fake of the sensor at the level of bus messages.
+  - Messages of a transfer are passed to the emulated sensor of the host
+  emulation. In hold master mode the clock is stretched by sleeping within
+  a combined transfer.
+*/
+class FakeSensor : public gbj_twowire_linux
+{
+public:
+  FakeSensor(uint8_t id = 0)
+    : sensor_(id){};
+
+protected:
+  int transfer(struct i2c_msg *msgs, uint8_t msgsLen)
+  {
+    for (uint8_t i = 0; i < msgsLen; i++)
+    {
+      struct i2c_msg &msg = msgs[i];
+      if (msg.addr != 0x40)
+      {
+        return ENXIO;
+      }
+      if (!(msg.flags & I2C_M_RD))
+      {
+        if (!sensor_.write(msg.buf, msg.len))
+        {
+          return EREMOTEIO;
+        }
+        continue;
+      }
+      if (!sensor_.read(msg.buf, msg.len, i > 0))
+      {
+        return ENXIO;
+      }
+    }
+    return 0;
+  }
+
+private:
+  gbj_htu21_emulated sensor_;
+};
+
+int main(int argc, char *argv[])
+{
+  unsigned long samples = 10;
+  unsigned long period = 1000;
+  bool holdMasterMode = true;
+  bool clockStretching = true;
+  bool fake = false;
+  unsigned fakes = 1;
+  std::vector<const char *> devices;
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+    {
+      samples = strtoul(argv[++i], NULL, 10);
+    }
+    else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc)
+    {
+      period = strtoul(argv[++i], NULL, 10);
+    }
+    else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc)
+    {
+      fakes = strtoul(argv[++i], NULL, 10);
+    }
+    else if (strcmp(argv[i], "-m") == 0)
+    {
+      holdMasterMode = false;
+    }
+    else if (strcmp(argv[i], "-x") == 0)
+    {
+      clockStretching = false;
+    }
+    else if (strcmp(argv[i], "-f") == 0)
+    {
+      fake = true;
+    }
+    else
+    {
+      devices.push_back(argv[i]);
+    }
+  }
+  unsigned count = fake ? fakes : devices.size();
+  if (count == 0 || count > gbj_htu21_group::PARAM_SENSORS_MAX)
+  {
+    fprintf(stderr,
+            "Usage: %s [-n samples] [-p period] [-m] [-x] device... | -f "
+            "[-c count]\n",
+            argv[0]);
+    return 1;
+  }
+  hostSetRealTime(true);
+  std::vector<gbj_twowire_linux *> buses;
+  std::vector<gbj_htu21 *> sensors;
+  for (unsigned i = 0; i < count; i++)
+  {
+    buses.push_back(fake ? new FakeSensor(i) : new gbj_twowire_linux());
+    if (!fake && !buses[i]->open(devices[i]))
+    {
+      fprintf(stderr, "Cannot open %s: %s\n", devices[i], strerror(errno));
+      return 1;
+    }
+    buses[i]->setClockStretching(clockStretching);
+    sensors.push_back(new gbj_htu21());
+    sensors[i]->setTransport(buses[i]);
+    if (sensors[i]->isError(sensors[i]->begin(holdMasterMode)))
+    {
+      fprintf(stderr,
+              "Begin %u: %s\n",
+              i,
+              sensors[i]->getResultTxt(sensors[i]->getLastResult()));
+      return 1;
+    }
+    uint64_t serial = sensors[i]->getSerialNumber();
+    fprintf(stderr,
+            "Serial number %u: %08X%08X\n",
+            i,
+            static_cast<unsigned>(serial >> 32),
+            static_cast<unsigned>(serial & 0xFFFFFFFF));
+  }
+  gbj_htu21_group group(sensors.data(), count);
+  std::vector<float> temperatures(count), humidities(count);
+  printf("time_ms,sensor,temperature,humidity,result\n");
+  unsigned long transfers = 0;
+  for (unsigned i = 0; i < count; i++)
+  {
+    // Transfers of initialization are not counted
+    transfers -= buses[i]->getTransfers();
+  }
+  for (unsigned long i = 0; i < samples; i++)
+  {
+    unsigned long timeStart = millis();
+    if (count == 1)
+    {
+      humidities[0] = sensors[0]->measureHumidity(temperatures[0]);
+    }
+    else
+    {
+      group.measure(temperatures.data(), humidities.data());
+    }
+    for (unsigned j = 0; j < count; j++)
+    {
+      printf("%lu,%u,%.2f,%.2f,%s\n",
+             timeStart,
+             j,
+             temperatures[j],
+             humidities[j],
+             sensors[j]->getResultTxt(sensors[j]->getLastResult()));
+    }
+    fflush(stdout);
+    if (i + 1 < samples && millis() - timeStart < period)
+    {
+      delay(period - (millis() - timeStart));
+    }
+  }
+  if (samples > 0)
+  {
+    for (unsigned i = 0; i < count; i++)
+    {
+      transfers += buses[i]->getTransfers();
+    }
+    fprintf(stderr,
+            "Transfers per sample: %.2f\n",
+            static_cast<float>(transfers) / samples);
+  }
+  for (unsigned i = 0; i < count; i++)
+  {
+    delete sensors[i];
+    delete buses[i];
+  }
+  return 0;
+}
@@ -0,0 +1,234 @@
+/*
+  NAME:
+  Host decoder of compressed logs written by gbjHTU21Log library.
+
+  DESCRIPTION:
+  The program rebuilds the time series from images of storages written by the
+  class gbj_htu21_log and writes it as CSV records to the standard output:
+    page_sequence,time,resolution,word_temp,word_rhum,temperature,humidity
+  - The program reads image files provided as arguments or the standard input.
+  - Pages are ordered by their sequence numbers, so that the series is in
+  chronological order regardless of the page rotation.
+  - The count of pages, samples, and used bytes per sample is reported to the
+  standard error.
+  - Options:
+    -p <size> - Page size in bytes, default 4096.
+  - Build on a host computer:
+    g++ -O2 -std=c++11 -o gbj_htu21_logdecode gbj_htu21_logdecode.cpp
+
+  LICENSE:
+  This program is free software; you can redistribute it and/or modify it under
+  the terms of the MIT License (MIT).
+
+  CREDENTIALS:
+  Author: Libor Gabaj
+*/
+#include <algorithm>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+// Page layout of the class gbj_htu21_log
+const uint8_t FORMAT_MAGIC = 0x48;
+const size_t FORMAT_HEADER = 18;
+const uint8_t FORMAT_ERASED = 0xFF;
+// Shifts of binary words by resolution code
+const uint8_t SHIFT_TEMP[] = { 2, 4, 3, 5 };
+const uint8_t SHIFT_RHUM[] = { 4, 8, 6, 5 };
+
+struct Page
+{
+  uint32_t sequence;
+  const uint8_t *data;
+};
+
+inline uint32_t readNumber(const uint8_t *data, uint8_t bytes)
+{
+  uint32_t number = 0;
+  for (uint8_t i = 0; i < bytes; i++)
+  {
+    number = (number << 8) | data[i];
+  }
+  return number;
+}
+
+inline int32_t unzigzag(uint32_t value)
+{
+  return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+}
+
+// Decode varint and return the number of its bytes or zero at incomplete one
+size_t getVarint(const uint8_t *data, size_t dataLen, uint32_t &value)
+{
+  value = 0;
+  for (size_t i = 0; i < dataLen && i < 5; i++)
+  {
+    value |= static_cast<uint32_t>(data[i] & 0x7F) << (7 * i);
+    if (!(data[i] & 0x80))
+    {
+      return i + 1;
+    }
+  }
+  return 0;
+}
+
+void printSample(uint32_t sequence,
+                 uint32_t time,
+                 uint8_t code,
+                 uint16_t temp,
+                 uint16_t rhum)
+{
+  uint16_t wordTemp = temp << SHIFT_TEMP[code];
+  uint16_t wordRhum = rhum << SHIFT_RHUM[code];
+  printf("%u,%u,%u,%u,%u,%.2f,%.2f\n",
+         sequence,
+         time,
+         code,
+         wordTemp,
+         wordRhum,
+         wordTemp * 175.72 / 65536.0 - 46.85,
+         wordRhum * 125.0 / 65536.0 - 6.0);
+}
+
+// Decode page and return the number of samples and used bytes
+unsigned long decodePage(const Page &page, size_t pageSize, size_t &used)
+{
+  const uint8_t *data = page.data;
+  uint8_t code = data[5] & 0x03;
+  uint32_t period = readNumber(&data[6], 4);
+  uint32_t time = readNumber(&data[10], 4);
+  uint16_t temp = readNumber(&data[14], 2);
+  uint16_t rhum = readNumber(&data[16], 2);
+  printSample(page.sequence, time, code, temp, rhum);
+  unsigned long samples = 1;
+  size_t idx = FORMAT_HEADER;
+  while (idx < pageSize && data[idx] != FORMAT_ERASED && !(data[idx] & 0x80))
+  {
+    size_t len = 1;
+    uint32_t value = data[idx] & 0x3F;
+    if (data[idx] & 0x40)
+    {
+      uint32_t high;
+      size_t varLen = getVarint(&data[idx + len], pageSize - idx - len, high);
+      if (varLen == 0)
+      {
+        break;
+      }
+      value |= high << 6;
+      len += varLen;
+    }
+    uint32_t count = 1;
+    if (value & 1)
+    {
+      size_t varLen = getVarint(&data[idx + len], pageSize - idx - len, count);
+      if (varLen == 0)
+      {
+        break;
+      }
+      len += varLen;
+    }
+    uint32_t delta;
+    size_t varLen = getVarint(&data[idx + len], pageSize - idx - len, delta);
+    if (varLen == 0)
+    {
+      break;
+    }
+    len += varLen;
+    temp += unzigzag(value >> 1);
+    rhum += unzigzag(delta);
+    time += period ? count * period : count;
+    printSample(page.sequence, time, code, temp, rhum);
+    samples++;
+    idx += len;
+  }
+  used += idx;
+  return samples;
+}
+
+int main(int argc, char *argv[])
+{
+  size_t pageSize = 4096;
+  std::vector<uint8_t> image;
+  std::vector<const char *> paths;
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "-p") == 0 && i + 1 < argc)
+    {
+      pageSize = strtoul(argv[++i], NULL, 10);
+    }
+    else
+    {
+      paths.push_back(argv[i]);
+    }
+  }
+  if (pageSize <= FORMAT_HEADER)
+  {
+    fprintf(stderr, "Usage: %s [-p page_size] [image...]\n", argv[0]);
+    return 1;
+  }
+  if (paths.empty())
+  {
+    paths.push_back(NULL);
+  }
+  for (size_t i = 0; i < paths.size(); i++)
+  {
+    FILE *file = paths[i] ? fopen(paths[i], "rb") : stdin;
+    if (file == NULL)
+    {
+      fprintf(stderr, "Cannot open %s\n", paths[i]);
+      return 1;
+    }
+    uint8_t chunk[1 << 16];
+    size_t readLen;
+    while ((readLen = fread(chunk, 1, sizeof(chunk), file)) > 0)
+    {
+      image.insert(image.end(), chunk, chunk + readLen);
+    }
+    if (paths[i])
+    {
+      fclose(file);
+    }
+  }
+  // Valid pages ordered from the oldest one relative to the newest one
+  std::vector<Page> pages;
+  for (size_t idx = 0; idx + pageSize <= image.size(); idx += pageSize)
+  {
+    if (image[idx] == FORMAT_MAGIC)
+    {
+      Page page = { static_cast<uint32_t>(readNumber(&image[idx + 1], 4)),
+                    &image[idx] };
+      pages.push_back(page);
+    }
+  }
+  uint32_t newest = 0;
+  for (size_t i = 0; i < pages.size(); i++)
+  {
+    if (i == 0 || static_cast<int32_t>(pages[i].sequence - newest) > 0)
+    {
+      newest = pages[i].sequence;
+    }
+  }
+  std::sort(pages.begin(), pages.end(), [newest](const Page &a, const Page &b) {
+    return static_cast<int32_t>(a.sequence - newest) <
+           static_cast<int32_t>(b.sequence - newest);
+  });
+  static char output[1 << 16];
+  setvbuf(stdout, output, _IOFBF, sizeof(output));
+  printf("page_sequence,time,resolution,word_temp,word_rhum,temperature,"
+         "humidity\n");
+  unsigned long samples = 0;
+  size_t used = 0;
+  for (size_t i = 0; i < pages.size(); i++)
+  {
+    samples += decodePage(pages[i], pageSize, used);
+  }
+  fflush(stdout);
+  fprintf(stderr,
+          "Pages: %zu, samples: %lu, bytes per sample: %.2f\n",
+          pages.size(),
+          samples,
+          samples ? static_cast<double>(used) / samples : 0.0);
+  return 0;
+}
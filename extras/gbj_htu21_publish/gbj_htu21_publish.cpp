@@ -0,0 +1,143 @@
+/*
+  NAME:
+  Host stress test of sample publication of gbjHTU21 library.
+
+  DESCRIPTION:
+  The program measures with the library in one writer thread as fast as
+  possible against an emulated sensor and reads published samples by the
+  method getSample() in reader threads at the same time.
+  - Each emulated sample has a unique pair of temperature and humidity, so that
+  a reader detects a torn read as a pair never published together.
+  - Summary CSV record is written to the standard output:
+    readers,seconds,publications,reads,reads_per_second,unread,torn
+  where unread is the number of calls returning false after all attempts
+  overlapped with publishing.
+  - Options:
+    -r <readers> - Number of reader threads, default number of CPU cores
+    minus one.
+    -t <seconds> - Duration of the test, default 2.
+  - Build on a host computer with all source files of the library from the
+  folder ../../src:
+    g++ -O2 -std=c++11 -pthread -I../host -I../../src -o gbj_htu21_publish
+      gbj_htu21_publish.cpp ../host/gbj_twowire.cpp
+      ../host/gbj_htu21_emulated.cpp ../../src/gbj_htu21.cpp ...
+
+  LICENSE:
+  This program is free software; you can redistribute it and/or modify it under
+  the terms of the MIT License (MIT).
+
+  CREDENTIALS:
+  Author: Libor Gabaj
+*/
+#include "gbj_htu21.h"
+#include "gbj_htu21_emulated.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Number of distinct emulated samples
+const unsigned SAMPLES = 256;
+
+int main(int argc, char *argv[])
+{
+  unsigned readers = std::max(1U, std::thread::hardware_concurrency() - 1);
+  unsigned seconds = 2;
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "-r") == 0 && i + 1 < argc)
+    {
+      readers = std::max(1, atoi(argv[++i]));
+    }
+    else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+    {
+      seconds = std::max(1, atoi(argv[++i]));
+    }
+    else
+    {
+      std::cerr << "Usage: " << argv[0] << " [-r readers] [-t seconds]"
+                << std::endl;
+      return 1;
+    }
+  }
+  gbj_htu21_emulated bus;
+  bus.setWords(0x5000, 0x6000, SAMPLES);
+  gbj_htu21 sensor = gbj_htu21();
+  sensor.setTransport(&bus);
+  if (sensor.isError(sensor.begin()))
+  {
+    std::cerr << "Begin: " << sensor.getResultTxt(sensor.getLastResult())
+              << std::endl;
+    return 1;
+  }
+  // Pairs published together, sorted by temperature for lookup
+  std::vector<std::pair<float, float> > pairs;
+  for (unsigned i = 0; i < SAMPLES; i++)
+  {
+    float temperature;
+    float humidity = sensor.measureHumidity(temperature);
+    pairs.push_back(std::make_pair(temperature, humidity));
+  }
+  std::sort(pairs.begin(), pairs.end());
+
+  std::atomic<bool> running(true);
+  std::atomic<unsigned long> publications(0);
+  std::atomic<unsigned long> reads(0), unread(0), torn(0);
+  std::thread writer([&]() {
+    float temperature;
+    unsigned long count = 0;
+    while (running.load(std::memory_order_relaxed))
+    {
+      sensor.measureHumidity(temperature);
+      count++;
+    }
+    publications = count;
+  });
+  std::vector<std::thread> workers;
+  for (unsigned r = 0; r < readers; r++)
+  {
+    workers.push_back(std::thread([&]() {
+      gbj_htu21::Sample sample;
+      unsigned long countReads = 0, countUnread = 0, countTorn = 0;
+      while (running.load(std::memory_order_relaxed))
+      {
+        if (!sensor.getSample(sample))
+        {
+          countUnread++;
+          continue;
+        }
+        countReads++;
+        std::vector<std::pair<float, float> >::const_iterator it =
+          std::lower_bound(pairs.begin(),
+                           pairs.end(),
+                           std::make_pair(sample.temperature, -1000.0f));
+        if (it == pairs.end() || it->first != sample.temperature ||
+            it->second != sample.humidity)
+        {
+          countTorn++;
+        }
+      }
+      reads += countReads;
+      unread += countUnread;
+      torn += countTorn;
+    }));
+  }
+  std::this_thread::sleep_for(std::chrono::seconds(seconds));
+  running = false;
+  writer.join();
+  for (size_t r = 0; r < workers.size(); r++)
+  {
+    workers[r].join();
+  }
+  std::cout << "readers,seconds,publications,reads,reads_per_second,unread,"
+               "torn\n"
+            << readers << ',' << seconds << ',' << publications << ','
+            << reads << ',' << reads / seconds << ',' << unread << ','
+            << torn << std::endl;
+  return torn > 0 ? 2 : 0;
+}
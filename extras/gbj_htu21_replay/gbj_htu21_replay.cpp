@@ -0,0 +1,608 @@
+/*
+  NAME:
+  Host replay of captured bus traces through gbjHTU21 library.
+
+  DESCRIPTION:
+  The program feeds recorded responses of the sensor on the two-wire bus into
+  the library running on a host computer and reports how the library handled
+  them.
+  - The program runs traces in parallel threads at full CPU speed, because the
+  time of the library is virtual.
+  - Trace files are provided as arguments or their paths one per line on the
+  standard input, if the only argument is "-".
+  - Summary CSV record per trace is written to the standard output:
+    trace,begin,samples,failures,last_result,conversions,nack_polls,
+    crc_errors,bus_bytes,recoveries,diverged,retry_budget,retries,stale,
+    stale_samples,success_pct,data_ms_avg,data_ms_max
+  - The retry budget is the number of conversions per measurement set in the
+  library, the retries are the conversions repeated within measurements of
+  the trace actually.
+  - The success rate is the percentage of samples with data, i.e., including
+  stale ones. The time to data is the virtual time of measuring a sample with
+  data in milliseconds.
+  - With option -s the decoded time series CSV records follow the summary:
+    trace,time_ms,temperature,humidity,result
+  - Option -j sets the number of threads, default is number of CPU cores.
+  - Options -r and -t override the retries and stale directives of all traces,
+  e.g., for comparing retry budgets on the same fault trace.
+  - Build on a host computer with all source files of the library from the
+  folder ../../src:
+    g++ -O2 -std=c++11 -pthread -I../host -I../../src -o gbj_htu21_replay
+      gbj_htu21_replay.cpp ../host/gbj_twowire.cpp ../../src/gbj_htu21.cpp ...
+
+  TRACE FORMAT:
+  Text file with one bus transaction per line in order of their appearance.
+  Tokens are separated by whitespace, bytes are hexadecimal.
+  - "# text" - Comment.
+  - "@ begin 0|1" - Whether the replay starts with begin(), default 1.
+  - "@ hold 0|1" - Hold master mode for begin() or measuring, default 1.
+  - "@ serial 0|1" - Whether the serial number is requested before measuring,
+  default 0. Its failure is reported as the result of begin.
+  - "@ recovery <n>" - Consecutive failed measurements triggering recovery,
+  default 0, i.e., disabled.
+  - "@ retries <n>" - Conversions at wrong CRC or status bits, default 0, i.e.,
+  the default of the library.
+  - "@ stale 0|1" - Whether stale value fallback is enabled, default 0.
+  - "@ queue 0|1" - Whether records are queued per command, default 0. Each
+  transaction takes the next unused record with the same direction and
+  command regardless of its position, so that the trace models responses of
+  the sensor to each command, e.g., injected CRC faults, and the replay ends
+  when a response runs out. Read only pollings share one queue, so that it is
+  suitable for hold master mode only.
+  - "S <result> <bytes>..." - Written bytes, e.g., "S OK E6 02".
+  - "R <result> <command>|- <bytes>..." - Command written before reading (or
+  "-" for read only transaction) and read bytes, e.g., "R OK E3 66 00 B2" or
+  "R NACK -".
+  Result is OK, NACK (no data to read, i.e., ERROR_RCV_DATA), ADDR (address
+  not acknowledged), or a decimal result code of the library gbjTwoWire.
+
+  LICENSE:
+  This program is free software; you can redistribute it and/or modify it under
+  the terms of the MIT License (MIT).
+
+  CREDENTIALS:
+  Author: Libor Gabaj
+*/
+#include "gbj_htu21.h"
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+struct Record
+{
+  bool receive;
+  gbj_twowire::ResultCodes result;
+  std::vector<uint8_t> command;
+  std::vector<uint8_t> data;
+};
+
+struct Setup
+{
+  bool begin;
+  bool hold;
+  bool serial;
+  bool queue;
+  int recovery;
+  int retries;
+  int stale;
+};
+
+struct Sample
+{
+  unsigned long time;
+  unsigned long duration;
+  float temperature;
+  float humidity;
+  gbj_twowire::ResultCodes result;
+};
+
+struct Report
+{
+  std::string trace;
+  std::string error;
+  gbj_twowire::ResultCodes begin;
+  gbj_twowire::ResultCodes lastResult;
+  unsigned long failures;
+  unsigned long conversions;
+  unsigned long nackPolls;
+  unsigned long crcErrors;
+  unsigned long busBytes;
+  unsigned long recoveries;
+  unsigned long stales;
+  unsigned long retries;
+  int retryBudget;
+  bool stale;
+  bool diverged;
+  std::vector<Sample> series;
+};
+
+class ReplayTransport : public gbj_twowire_transport
+{
+public:
+  ReplayTransport(const std::vector<Record> &records,
+                  Report &report,
+                  bool queue)
+    : records_(records)
+    , report_(report)
+    , used_(records.size(), false)
+    , queue_(queue)
+    , exhausted_(false)
+    , idx_(0)
+    , conversion_(0){};
+
+  inline bool done()
+  {
+    return (queue_ ? exhausted_ : idx_ >= records_.size()) ||
+           report_.diverged;
+  }
+  inline bool exhausted() { return exhausted_; }
+  // Start of a sample for counting repeated conversions
+  inline void startSample() { conversion_ = 0; }
+
+  ResultCodes send(uint8_t address, const uint8_t *data, uint8_t dataLen)
+  {
+    const Record *record = next(false, data, dataLen);
+    return record ? record->result : ResultCodes::ERROR_BUS;
+  }
+
+  ResultCodes receive(uint8_t address,
+                      const uint8_t *command,
+                      uint8_t commandLen,
+                      uint32_t delay,
+                      uint8_t *data,
+                      uint8_t dataLen)
+  {
+    const Record *record = next(true, command, commandLen);
+    if (record == NULL)
+    {
+      return ResultCodes::ERROR_BUS;
+    }
+    ::delay(delay);
+    if (record->result == ResultCodes::SUCCESS)
+    {
+      memset(data, 0, dataLen);
+      memcpy(data,
+             record->data.data(),
+             std::min(record->data.size(), static_cast<size_t>(dataLen)));
+      report_.busBytes += dataLen;
+      check(*record);
+    }
+    else if (record->result == ResultCodes::ERROR_RCV_DATA)
+    {
+      report_.nackPolls++;
+    }
+    return record->result;
+  }
+
+private:
+  const std::vector<Record> &records_;
+  Report &report_;
+  std::vector<bool> used_;
+  bool queue_;
+  bool exhausted_;
+  size_t idx_;
+  // Recent conversion command within a sample
+  uint8_t conversion_;
+
+  inline bool matches(const Record &record,
+                      bool receive,
+                      const uint8_t *bytes,
+                      uint8_t bytesLen)
+  {
+    return record.receive == receive && record.command.size() == bytesLen &&
+           std::equal(record.command.begin(), record.command.end(), bytes);
+  }
+
+  // Next unused record with the same direction and command
+  const Record *dequeue(bool receive, const uint8_t *bytes, uint8_t bytesLen)
+  {
+    bool known = false;
+    for (size_t i = 0; i < records_.size(); i++)
+    {
+      if (matches(records_[i], receive, bytes, bytesLen))
+      {
+        known = true;
+        if (!used_[i])
+        {
+          used_[i] = true;
+          return &records_[i];
+        }
+      }
+    }
+    // Command missing in the trace diverges, used up responses end it
+    (known ? exhausted_ : report_.diverged) = true;
+    return NULL;
+  }
+
+  const Record *next(bool receive, const uint8_t *bytes, uint8_t bytesLen)
+  {
+    if (done())
+    {
+      report_.diverged = !queue_ && (idx_ < records_.size());
+      return NULL;
+    }
+    if (queue_)
+    {
+      const Record *record = dequeue(receive, bytes, bytesLen);
+      return record ? account(*record, receive) : NULL;
+    }
+    const Record &record = records_[idx_++];
+    if (!matches(record, receive, bytes, bytesLen))
+    {
+      report_.diverged = true;
+      return NULL;
+    }
+    return account(record, receive);
+  }
+
+  // Count conversions and bytes of a transaction
+  const Record *account(const Record &record, bool receive)
+  {
+    uint8_t cmd = record.command.empty() ? 0 : record.command.back();
+    if (cmd == 0xE3 || cmd == 0xE5 || cmd == 0xF3 || cmd == 0xF5)
+    {
+      report_.conversions++;
+      // The same quantity converted again within a sample is a retry
+      report_.retries += cmd == conversion_ ? 1 : 0;
+      conversion_ = cmd;
+    }
+    // Address byte for writing command and for reading
+    report_.busBytes +=
+      record.command.size() + (record.command.empty() ? 0 : 1);
+    report_.busBytes += receive ? 1 : 0;
+    return &record;
+  }
+
+  // Count CRC failures of measurement and serial number responses
+  void check(const Record &record)
+  {
+    gbj_htu21 sensor;
+    const std::vector<uint8_t> &d = record.data;
+    uint16_t cmd = 0;
+    for (size_t i = 0; i < record.command.size(); i++)
+    {
+      cmd = (cmd << 8) | record.command[i];
+    }
+    // Read only polling follows a measurement command
+    bool measure = (cmd == 0xE3 || cmd == 0xE5 || cmd == 0xF3 || cmd == 0xF5 ||
+                    record.command.empty());
+    size_t group = (measure || cmd == 0xFCC9) ? 3 : (cmd == 0xFA0F ? 2 : 0);
+    if (group == 0)
+    {
+      return;
+    }
+    for (size_t i = 0; i + group <= d.size(); i += group)
+    {
+      if (sensor.calculateCrc8(&d[i], group - 1) != d[i + group - 1])
+      {
+        report_.crcErrors++;
+        return;
+      }
+    }
+  }
+};
+
+bool parseResult(const std::string &token, gbj_twowire::ResultCodes &result)
+{
+  if (token == "OK")
+  {
+    result = gbj_twowire::ResultCodes::SUCCESS;
+  }
+  else if (token == "NACK")
+  {
+    result = gbj_twowire::ResultCodes::ERROR_RCV_DATA;
+  }
+  else if (token == "ADDR")
+  {
+    result = gbj_twowire::ResultCodes::ERROR_ADDR;
+  }
+  else
+  {
+    char *end;
+    unsigned long code = strtoul(token.c_str(), &end, 10);
+    if (*end != '\0' || token.empty() || code > 0xFF)
+    {
+      return false;
+    }
+    result = static_cast<gbj_twowire::ResultCodes>(code);
+  }
+  return true;
+}
+
+bool parseBytes(const std::string &token, std::vector<uint8_t> &bytes)
+{
+  if (token.empty() || token.size() % 2 != 0)
+  {
+    return false;
+  }
+  for (size_t i = 0; i < token.size(); i += 2)
+  {
+    char *end;
+    std::string pair = token.substr(i, 2);
+    unsigned long value = strtoul(pair.c_str(), &end, 16);
+    if (*end != '\0')
+    {
+      return false;
+    }
+    bytes.push_back(static_cast<uint8_t>(value));
+  }
+  return true;
+}
+
+bool loadTrace(const std::string &path,
+               std::vector<Record> &records,
+               Setup &setup,
+               std::string &error)
+{
+  std::ifstream file(path.c_str());
+  if (!file)
+  {
+    error = "cannot open";
+    return false;
+  }
+  std::string line;
+  unsigned long lineNum = 0;
+  while (std::getline(file, line))
+  {
+    lineNum++;
+    std::istringstream tokens(line);
+    std::string op, token;
+    if (!(tokens >> op) || op[0] == '#')
+    {
+      continue;
+    }
+    if (op == "@")
+    {
+      std::string key;
+      int value;
+      if (!(tokens >> key >> value))
+      {
+        error = "bad directive at line " + std::to_string(lineNum);
+        return false;
+      }
+      if (key == "recovery")
+      {
+        setup.recovery = value;
+      }
+      else if (key == "retries")
+      {
+        setup.retries = value;
+      }
+      else if (key == "stale")
+      {
+        setup.stale = value;
+      }
+      else
+      {
+        (key == "begin"
+           ? setup.begin
+           : (key == "serial" ? setup.serial
+                              : (key == "queue" ? setup.queue : setup.hold))) =
+          (value != 0);
+      }
+      continue;
+    }
+    Record record;
+    record.receive = (op == "R");
+    bool valid = (op == "R" || op == "S") && (tokens >> token) &&
+                 parseResult(token, record.result);
+    if (valid && record.receive)
+    {
+      valid = (tokens >> token) &&
+              (token == "-" || parseBytes(token, record.command));
+    }
+    while (valid && (tokens >> token))
+    {
+      valid = parseBytes(token,
+                         record.receive ? record.data : record.command);
+    }
+    if (!valid)
+    {
+      error = "bad record at line " + std::to_string(lineNum);
+      return false;
+    }
+    records.push_back(record);
+  }
+  return true;
+}
+
+void replay(Report &report, const Setup &overrides)
+{
+  std::vector<Record> records;
+  Setup setup = { true, true, false, false, 0, 0, 0 };
+  if (!loadTrace(report.trace, records, setup, report.error))
+  {
+    return;
+  }
+  setup.retries = overrides.retries ? overrides.retries : setup.retries;
+  setup.stale = overrides.stale >= 0 ? overrides.stale : setup.stale;
+  ReplayTransport transport(records, report, setup.queue);
+  gbj_htu21 sensor;
+  sensor.setTransport(&transport);
+  hostSetMicros(0);
+  if (setup.begin)
+  {
+    report.begin = sensor.begin(setup.hold);
+  }
+  else
+  {
+    sensor.setHoldMasterMode(setup.hold);
+  }
+  sensor.setRecoveryThreshold(setup.recovery);
+  if (setup.retries)
+  {
+    sensor.setRetries(setup.retries);
+  }
+  if (setup.stale)
+  {
+    sensor.setStaleEnabled();
+  }
+  report.retryBudget = sensor.getRetries();
+  report.stale = sensor.getStaleEnabled();
+  if (setup.serial && sensor.isSuccess())
+  {
+    sensor.getSerialNumber();
+    report.begin = sensor.getLastResult();
+  }
+  while (!transport.done())
+  {
+    Sample sample;
+    transport.startSample();
+    sample.time = millis();
+    sample.humidity = sensor.measureHumidity(sample.temperature);
+    sample.duration = millis() - sample.time;
+    sample.result = sensor.getLastResult();
+    // Transaction missing in the trace is not a measurement
+    if (report.diverged || transport.exhausted())
+    {
+      break;
+    }
+    report.failures += sensor.isError() ? 1 : 0;
+    report.stales += sensor.isSuccess() && sensor.getStale() ? 1 : 0;
+    report.lastResult = sample.result;
+    report.series.push_back(sample);
+  }
+  report.recoveries = sensor.getRecoveries();
+}
+
+int main(int argc, char *argv[])
+{
+  std::vector<Report> reports;
+  bool series = false;
+  Setup overrides = { true, true, false, false, 0, 0, -1 };
+  unsigned threads = std::thread::hardware_concurrency();
+  for (int i = 1; i < argc; i++)
+  {
+    std::string arg = argv[i];
+    if (arg == "-s")
+    {
+      series = true;
+    }
+    else if (arg == "-j" && i + 1 < argc)
+    {
+      threads = atoi(argv[++i]);
+    }
+    else if (arg == "-r" && i + 1 < argc)
+    {
+      overrides.retries = atoi(argv[++i]);
+    }
+    else if (arg == "-t" && i + 1 < argc)
+    {
+      overrides.stale = atoi(argv[++i]) != 0;
+    }
+    else if (arg == "-")
+    {
+      std::string path;
+      while (std::getline(std::cin, path))
+      {
+        if (!path.empty())
+        {
+          reports.push_back(Report());
+          reports.back().trace = path;
+        }
+      }
+    }
+    else
+    {
+      reports.push_back(Report());
+      reports.back().trace = arg;
+    }
+  }
+  if (reports.empty())
+  {
+    std::cerr << "Usage: " << argv[0]
+              << " [-s] [-j threads] [-r retries] [-t 0|1] trace... | -"
+              << std::endl;
+    return 1;
+  }
+  for (size_t i = 0; i < reports.size(); i++)
+  {
+    reports[i].begin = gbj_twowire::ResultCodes::SUCCESS;
+    reports[i].lastResult = gbj_twowire::ResultCodes::SUCCESS;
+    reports[i].failures = reports[i].conversions = 0;
+    reports[i].nackPolls = reports[i].crcErrors = reports[i].busBytes = 0;
+    reports[i].recoveries = reports[i].stales = 0;
+    reports[i].retries = reports[i].retryBudget = 0;
+    reports[i].stale = false;
+    reports[i].diverged = false;
+  }
+  // Workers take traces one by one
+  std::atomic<size_t> next(0);
+  std::vector<std::thread> workers;
+  threads =
+    std::max(1U, std::min(threads, static_cast<unsigned>(reports.size())));
+  for (unsigned t = 0; t < threads; t++)
+  {
+    workers.push_back(std::thread([&]() {
+      size_t idx;
+      while ((idx = next++) < reports.size())
+      {
+        replay(reports[idx], overrides);
+      }
+    }));
+  }
+  for (size_t t = 0; t < workers.size(); t++)
+  {
+    workers[t].join();
+  }
+  std::ios::sync_with_stdio(false);
+  std::cout << "trace,begin,samples,failures,last_result,conversions,"
+               "nack_polls,crc_errors,bus_bytes,recoveries,diverged,"
+               "retry_budget,retries,stale,stale_samples,success_pct,"
+               "data_ms_avg,data_ms_max\n";
+  for (size_t i = 0; i < reports.size(); i++)
+  {
+    const Report &r = reports[i];
+    if (!r.error.empty())
+    {
+      std::cerr << r.trace << ": " << r.error << std::endl;
+      continue;
+    }
+    // Time to data of samples with data
+    unsigned long total = 0, longest = 0;
+    for (size_t j = 0; j < r.series.size(); j++)
+    {
+      const Sample &s = r.series[j];
+      if (s.result == gbj_twowire::ResultCodes::SUCCESS)
+      {
+        total += s.duration;
+        longest = std::max(longest, s.duration);
+      }
+    }
+    size_t delivered = r.series.size() - r.failures;
+    std::cout << r.trace << ',' << gbj_twowire::getResultTxt(r.begin) << ','
+              << r.series.size() << ',' << r.failures << ','
+              << gbj_twowire::getResultTxt(r.lastResult) << ','
+              << r.conversions << ',' << r.nackPolls << ',' << r.crcErrors
+              << ',' << r.busBytes << ',' << r.recoveries << ','
+              << (r.diverged ? 1 : 0) << ',' << r.retryBudget << ','
+              << r.retries << ','
+              << (r.stale ? 1 : 0) << ',' << r.stales << ',' << std::fixed
+              << std::setprecision(1)
+              << (r.series.empty() ? 0.0 : 100.0 * delivered / r.series.size())
+              << ',' << (delivered ? 1.0 * total / delivered : 0.0) << ','
+              << longest << '\n';
+    std::cout.unsetf(std::ios::floatfield);
+    std::cout << std::setprecision(6);
+  }
+  if (series)
+  {
+    std::cout << "trace,time_ms,temperature,humidity,result\n";
+    for (size_t i = 0; i < reports.size(); i++)
+    {
+      const Report &r = reports[i];
+      for (size_t j = 0; j < r.series.size(); j++)
+      {
+        const Sample &s = r.series[j];
+        std::cout << r.trace << ',' << s.time << ',' << s.temperature << ','
+                  << s.humidity << ',' << gbj_twowire::getResultTxt(s.result)
+                  << '\n';
+      }
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,131 @@
+/*
+  NAME:
+  Host check of power-aware scheduler of gbjHTU21 library.
+
+  DESCRIPTION:
+  The program runs the class gbj_htu21_scheduler against an emulated sensor
+  for a set of sampling periods and energy budgets and checks the selected
+  configuration and energy estimates.
+  - For each case the sensor is set to a measuring mode and usage of typical
+  values, the scheduler is initialized by begin(), and the selected resolution
+  and result code are compared to the expected ones. The resolution is taken
+  from the user register of the emulated sensor.
+  - The charge per sample by estimateCharge() is compared to the expected
+  charge computed by hand for each case from datasheet maximal current 500 uA,
+  sleep current 0.14 uA, maximal conversion times, and 90 us per bus byte at
+  100 kHz, within 1 nC.
+  - Then the scheduler runs for a number of periods in virtual time and the
+  achieved duty cycle is compared to the estimated one within 0.2 %.
+  - CSV record per case is written to the standard output:
+    period_ms,budget_nc,code,hold,typ,result,charge_nc,expected_nc,
+    duty_estimated,duty_achieved,check
+  - The program exits with nonzero status, if any check fails.
+  - Build on a host computer with all source files of the library from the
+  folder ../../src:
+    g++ -O2 -std=c++11 -I../host -I../../src -o gbj_htu21_schedule
+      gbj_htu21_schedule.cpp ../host/gbj_twowire.cpp
+      ../host/gbj_htu21_emulated.cpp ../../src/gbj_htu21.cpp
+      ../../src/gbj_htu21_scheduler.cpp
+
+  LICENSE:
+  This program is free software; you can redistribute it and/or modify it under
+  the terms of the MIT License (MIT).
+
+  CREDENTIALS:
+  Author: Libor Gabaj
+*/
+#include "gbj_htu21_emulated.h"
+#include "gbj_htu21_scheduler.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+struct Case
+{
+  uint32_t period;
+  uint32_t budget;
+  bool hold;
+  bool typ;
+  uint8_t code;
+  bool fit;
+  // Expected charge per sample in nanocoulombs
+  uint32_t charge;
+};
+
+int main()
+{
+  const Case cases[] = {
+    // 500 * (50 + 16 + 12 * 0.09) + 0.14 * (1000 - 67.08)
+    { 1000, 40000, true, false, 0, true, 33670 },
+    // Waiting for typical conversion times does not shorten conversions,
+    // 500 * (25 + 5 + (12 + 3 + 1) * 0.09) + 0.14 * (1000 - 31.44)
+    { 1000, 30000, false, true, 2, true, 15855 },
+    // 500 * (50 + 16 + (12 + 6 + 2) * 0.09) + 0.14 * (1000 - 67.8)
+    { 1000, 34100, false, true, 0, true, 34030 },
+    { 1000, 34000, false, true, 2, true, 15855 },
+    // 500 * (13 + 3 + 12 * 0.09) + 0.14 * (1000 - 17.08)
+    { 1000, 15000, true, false, 1, true, 8677 },
+    // 500 * (7 + 8 + 12 * 0.09) + 0.14 * (1000 - 16.08)
+    { 1000, 8500, false, false, 3, true, 8177 },
+    { 1000, 8000, true, false, 3, false, 8177 },
+    // Period shorter than conversion times of the finest resolution,
+    // 500 * (25 + 5 + 12 * 0.09) + 0.14 * (50 - 31.08)
+    { 50, 1000000, true, false, 2, true, 15542 },
+    // Sleep charge of long period exceeds the budget,
+    // 500 * (25 + 5 + 12 * 0.09) + 0.14 * (60000 - 31.08)
+    { 60000, 40000, true, false, 2, true, 23935 },
+  };
+  const unsigned periods = 20;
+  bool valid = true;
+  printf("period_ms,budget_nc,code,hold,typ,result,charge_nc,expected_nc,"
+         "duty_estimated,duty_achieved,check\n");
+  for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+  {
+    const Case &c = cases[i];
+    gbj_htu21_emulated bus;
+    gbj_htu21 sensor;
+    gbj_htu21_scheduler scheduler(sensor);
+    // Bits of bytes with acknowledge at 100 kHz
+    bus.setByteTime(9 * 10);
+    sensor.setTransport(&bus);
+    sensor.begin(c.hold);
+    if (c.typ)
+    {
+      sensor.setUseValuesTyp();
+    }
+    gbj_htu21::ResultCodes result = scheduler.begin(c.period, c.budget);
+    uint8_t code = bus.getResolution();
+    bool hold = sensor.getHoldMasterMode();
+    bool typ = sensor.getUseValuesTyp();
+    uint32_t charge = scheduler.estimateCharge(code, hold, typ);
+    bool check = code == c.code && hold == c.hold && typ == c.typ &&
+                 sensor.isSuccess(result) == c.fit &&
+                 charge == scheduler.getChargeSample() &&
+                 abs(static_cast<int>(charge) - static_cast<int>(c.charge)) <=
+                   1;
+    // Run the scheduler in virtual time
+    unsigned long timeEnd = millis() + periods * c.period;
+    while (millis() < timeEnd)
+    {
+      check = check && (!scheduler.run() || sensor.isSuccess());
+      delay(1);
+    }
+    uint16_t dutyEstimated = scheduler.getDutyCycleEstimated();
+    uint16_t dutyAchieved = scheduler.getDutyCycle();
+    check = check && scheduler.getSamples() >= periods &&
+            abs(static_cast<int>(dutyEstimated) - dutyAchieved) <= 20;
+    printf("%u,%u,%u,%u,%u,%s,%u,%u,%.2f,%.2f,%s\n",
+           c.period,
+           c.budget,
+           code,
+           hold,
+           typ,
+           gbj_twowire::getResultTxt(result),
+           charge,
+           c.charge,
+           dutyEstimated / 100.0,
+           dutyAchieved / 100.0,
+           check ? "OK" : "FAIL");
+    valid = valid && check;
+  }
+  return valid ? 0 : 2;
+}
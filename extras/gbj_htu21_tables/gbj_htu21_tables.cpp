@@ -0,0 +1,204 @@
+/*
+  NAME:
+  Generator of lookup tables of gbjHTU21 library.
+
+  DESCRIPTION:
+  The program computes the lookup tables of the library for derived
+  quantities in integer arithmetic from floating point formulas.
+  - LOG_RHUM - Natural logarithm of relative humidity 1 ~ 100 % in steps of
+  1 %, scaled by 4096, i.e., round(ln(RH / 100) * 4096).
+  - VAPOUR_DENSITY - Saturation vapour density in mg/m3 for temperature
+  -40 ~ 126 centigrades in steps of 2 centigrades by Magnus formula, i.e.,
+  round(216.74 * 6.112 * exp(17.62 * T / (243.12 + T)) / (273.15 + T) * 1000).
+  - Without options the tables are written to the standard output as source
+  code with the same number of entries per line as in the source file, so that
+  they can replace the tables there.
+  - Option -c <source> checks every entry of both tables in the source file,
+  e.g., ../../src/gbj_htu21.cpp, against the computed ones, writes the number
+  of entries and mismatches per table, and exits with nonzero status, if any
+  entry differs or a table is not found.
+  - Build on a host computer without the library:
+    g++ -O2 -std=c++11 -o gbj_htu21_tables gbj_htu21_tables.cpp
+
+  LICENSE:
+  This program is free software; you can redistribute it and/or modify it under
+  the terms of the MIT License (MIT).
+
+  CREDENTIALS:
+  Author: Libor Gabaj
+*/
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+struct Table
+{
+  const char *name;
+  const char *type;
+  // Number of entries per line in the source file
+  unsigned columns;
+  std::vector<long> values;
+};
+
+std::vector<long> logRhum()
+{
+  std::vector<long> values;
+  for (int rh = 1; rh <= 100; rh++)
+  {
+    values.push_back(lround(log(rh / 100.0) * 4096));
+  }
+  return values;
+}
+
+std::vector<long> vapourDensity()
+{
+  std::vector<long> values;
+  for (int t = -40; t <= 126; t += 2)
+  {
+    values.push_back(lround(216.74 * 6.112 * exp(17.62 * t / (243.12 + t)) /
+                            (273.15 + t) * 1000));
+  }
+  return values;
+}
+
+// Columns aligned to the widest entry
+void printTable(const Table &table)
+{
+  const std::vector<long> &values = table.values;
+  size_t width = 0;
+  for (size_t i = 0; i < values.size(); i++)
+  {
+    width = std::max(width, std::to_string(values[i]).size() + 1);
+  }
+  printf("static const %s %s[] PROGMEM = {\n", table.type, table.name);
+  for (size_t i = 0; i < values.size(); i++)
+  {
+    unsigned column = i % table.columns;
+    std::string entry = std::to_string(values[i]) + ",";
+    if (column == 0)
+    {
+      printf("  ");
+    }
+    bool last = column == table.columns - 1 || i == values.size() - 1;
+    printf("%-*s%s", last ? 0 : static_cast<int>(width + 1),
+           entry.c_str(), last ? "\n" : "");
+  }
+  printf("};\n");
+}
+
+// Entries of the table between braces after its name in the source text
+bool parseTable(const std::string &source,
+                const char *name,
+                std::vector<long> &values)
+{
+  size_t pos = source.find(std::string(name) + "[] PROGMEM = {");
+  if (pos == std::string::npos)
+  {
+    return false;
+  }
+  pos = source.find('{', pos);
+  size_t end = source.find("};", pos);
+  if (end == std::string::npos)
+  {
+    return false;
+  }
+  std::string body = source.substr(pos + 1, end - pos - 1);
+  const char *text = body.c_str();
+  char *next;
+  while (true)
+  {
+    long value = strtol(text, &next, 10);
+    if (next == text)
+    {
+      break;
+    }
+    values.push_back(value);
+    text = next;
+    while (*text == ',' || *text == ' ' || *text == '\n')
+    {
+      text++;
+    }
+  }
+  return true;
+}
+
+int checkTables(const char *path, const Table *tables, size_t count)
+{
+  FILE *file = fopen(path, "r");
+  if (file == NULL)
+  {
+    fprintf(stderr, "Cannot open %s\n", path);
+    return 1;
+  }
+  std::string source;
+  char buffer[4096];
+  size_t len;
+  while ((len = fread(buffer, 1, sizeof(buffer), file)) > 0)
+  {
+    source.append(buffer, len);
+  }
+  fclose(file);
+  bool valid = true;
+  printf("table,entries,mismatches,check\n");
+  for (size_t i = 0; i < count; i++)
+  {
+    const Table &table = tables[i];
+    std::vector<long> values;
+    if (!parseTable(source, table.name, values))
+    {
+      printf("%s,0,0,MISSING\n", table.name);
+      valid = false;
+      continue;
+    }
+    unsigned mismatches = 0;
+    for (size_t j = 0; j < table.values.size(); j++)
+    {
+      if (j >= values.size() || values[j] != table.values[j])
+      {
+        mismatches++;
+        fprintf(stderr,
+                "%s[%zu]: %ld, expected %ld\n",
+                table.name,
+                j,
+                j < values.size() ? values[j] : 0L,
+                table.values[j]);
+      }
+    }
+    bool check = mismatches == 0 && values.size() == table.values.size();
+    valid &= check;
+    printf("%s,%zu,%u,%s\n",
+           table.name,
+           values.size(),
+           mismatches,
+           check ? "OK" : "FAIL");
+  }
+  return valid ? 0 : 1;
+}
+
+int main(int argc, char *argv[])
+{
+  const Table tables[] = {
+    { "LOG_RHUM", "int16_t", 10, logRhum() },
+    { "VAPOUR_DENSITY", "uint32_t", 8, vapourDensity() },
+  };
+  const size_t count = sizeof(tables) / sizeof(tables[0]);
+  if (argc == 3 && strcmp(argv[1], "-c") == 0)
+  {
+    return checkTables(argv[2], tables, count);
+  }
+  if (argc != 1)
+  {
+    fprintf(stderr, "Usage: %s [-c source]\n", argv[0]);
+    return 1;
+  }
+  for (size_t i = 0; i < count; i++)
+  {
+    printf("%s", i ? "\n" : "");
+    printTable(tables[i]);
+  }
+  return 0;
+}
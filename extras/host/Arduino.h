@@ -0,0 +1,67 @@
+/*
+  NAME:
+  Host emulation of Arduino core for gbjHTU21 library.
+
+  DESCRIPTION:
+  The header provides the subset of the Arduino core utilized by the library,
+  so that the library can be compiled and run on a host computer.
+  - Time is virtual and thread local. It advances only by waiting, so that
+  programs run at full CPU speed and independent threads do not interfere.
+  - Real time of the monotonic clock can be switched on per thread for
+  communication with real devices.
+
+  LICENSE:
+  This program is free software; you can redistribute it and/or modify it under
+  the terms of the MIT License (MIT).
+
+  CREDENTIALS:
+  Author: Libor Gabaj
+*/
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+#include <inttypes.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+
+typedef std::string String;
+
+#define B0 0
+#define B1 1
+#define B00 0
+#define B01 1
+#define B10 2
+#define B11 3
+#define B00000001 0x01
+#define B00000100 0x04
+#define B01111111 0x7F
+#define B10000000 0x80
+#define B11111011 0xFB
+#define B11111110 0xFE
+#define B10000101 0x85
+
+#define PROGMEM
+#define pgm_read_byte(addr) (*reinterpret_cast<const uint8_t *>(addr))
+#define pgm_read_word(addr) (*reinterpret_cast<const uint16_t *>(addr))
+#define pgm_read_dword(addr) (*reinterpret_cast<const uint32_t *>(addr))
+#define memcpy_P(dest, src, num) memcpy((dest), (src), (num))
+
+#define constrain(amt, low, high)                                              \
+  ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define lowByte(w) ((uint8_t)((w)&0xff))
+#define highByte(w) ((uint8_t)((w) >> 8))
+
+// Virtual time of the current thread
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+// Set virtual time of the current thread in microseconds
+void hostSetMicros(uint64_t us);
+// Switch the current thread between virtual and real time
+void hostSetRealTime(bool realTime);
+
+#endif
@@ -0,0 +1,170 @@
+#include "gbj_htu21_emulated.h"
+#include "gbj_htu21.h"
+#include <stdio.h>
+
+// Typical conversion times in milliseconds by resolution code
+static const uint8_t TEMP_TIME_TYP[] = { 44, 11, 22, 6 };
+static const uint8_t RHUM_TIME_TYP[] = { 14, 3, 4, 7 };
+
+gbj_htu21_emulated::ResultCodes gbj_htu21_emulated::send(uint8_t address,
+                                                         const uint8_t *data,
+                                                         uint8_t dataLen)
+{
+  transfer(1 + dataLen);
+  if (address != Params::PARAM_ADDRESS)
+  {
+    return ResultCodes::ERROR_ADDR;
+  }
+  write(data, dataLen);
+  return ResultCodes::SUCCESS;
+}
+
+gbj_htu21_emulated::ResultCodes gbj_htu21_emulated::receive(
+  uint8_t address,
+  const uint8_t *command,
+  uint8_t commandLen,
+  uint32_t delay,
+  uint8_t *data,
+  uint8_t dataLen)
+{
+  if (address != Params::PARAM_ADDRESS)
+  {
+    transfer(1);
+    return ResultCodes::ERROR_ADDR;
+  }
+  if (commandLen)
+  {
+    transfer(1 + commandLen);
+    write(command, commandLen);
+  }
+  ::delay(delay);
+  // Command in the same transaction stretches the clock in hold master mode
+  if (!read(data, dataLen, commandLen > 0))
+  {
+    transfer(1);
+    return ResultCodes::ERROR_RCV_DATA;
+  }
+  transfer(1 + dataLen);
+  return ResultCodes::SUCCESS;
+}
+
+bool gbj_htu21_emulated::write(const uint8_t *data, uint8_t dataLen)
+{
+  if (dataLen == 0)
+  {
+    return true;
+  }
+  command_ = data[0];
+  uint8_t code = getResolution();
+  switch (command_)
+  {
+    case 0xE3:
+    case 0xF3:
+      ready_ = millis() + TEMP_TIME_TYP[code];
+      log("trigger_temp");
+      break;
+
+    case 0xE5:
+    case 0xF5:
+      ready_ = millis() + RHUM_TIME_TYP[code];
+      log("trigger_rhum");
+      break;
+
+    case 0xE6:
+      userReg_ = dataLen > 1 ? data[1] : userReg_;
+      log("write_register");
+      break;
+
+    case 0xFE:
+      userReg_ = 0x02;
+      command_ = 0;
+      log("reset");
+      break;
+
+    case 0xFA:
+    case 0xFC:
+      command_ = (data[0] << 8) | (dataLen > 1 ? data[1] : 0);
+      break;
+  }
+  return true;
+}
+
+bool gbj_htu21_emulated::read(uint8_t *data, uint8_t dataLen, bool stretch)
+{
+  uint16_t word;
+  switch (command_)
+  {
+    case 0xE3:
+    case 0xE5:
+    case 0xF3:
+    case 0xF5:
+      if (millis() < ready_)
+      {
+        // Only hold master mode commands stretch the clock
+        if (!stretch || (command_ & 0x10))
+        {
+          return false;
+        }
+        ::delay(ready_ - millis());
+      }
+      if (command_ & 0x04)
+      {
+        word = (rhumWord_ + ((counter_ % variants_) << 4)) | 0x02;
+        counter_ = (counter_ + 1) % variants_;
+        log("read_rhum");
+      }
+      else
+      {
+        word = tempWord_ + ((counter_ % variants_) << 4);
+        log("read_temp");
+      }
+      data[0] = word >> 8;
+      data[1] = word & 0xFF;
+      data[2] = crc(data, 2);
+      // Result is read just once
+      command_ = 0;
+      break;
+
+    case 0xE7:
+      data[0] = userReg_;
+      log("read_register");
+      break;
+
+    case 0xFA0F:
+      for (uint8_t i = 0; i < 4 && 2 * i + 1 < dataLen; i++)
+      {
+        data[2 * i] = 0x48 + 4 * id_ + i;
+        data[2 * i + 1] = crc(&data[2 * i], 1);
+      }
+      log("read_snb");
+      break;
+
+    case 0xFCC9:
+      data[0] = 0x32;
+      data[1] = 0x15;
+      data[2] = crc(data, 2);
+      data[3] = 0x80;
+      data[4] = 0x00;
+      data[5] = crc(&data[3], 2);
+      log("read_snac");
+      break;
+
+    default:
+      return false;
+  }
+  return true;
+}
+
+void gbj_htu21_emulated::log(const char *transaction)
+{
+  if (logging_)
+  {
+    printf("%lu,%u,%s\n", millis(), id_, transaction);
+  }
+}
+
+uint8_t gbj_htu21_emulated::crc(const uint8_t *data, uint8_t len)
+{
+  gbj_htu21 sensor;
+  return sensor.calculateCrc8(data, len);
+}
@@ -0,0 +1,135 @@
+/*
+  NAME:
+  Emulated sensor of gbjTwoWire host emulation for gbjHTU21 library.
+
+  DESCRIPTION:
+  The transport emulates the sensor HTU21D(F) on its own bus, so that host
+  programs can run the library without a captured trace or a device.
+  - It responds to reset, user register, measuring, and serial number commands.
+  The identifier distinguishes SNB bytes of serial numbers of more sensors.
+  - A conversion finishes after the typical conversion time at the resolution
+  set in the user register. In no hold master mode read only pollings before
+  it are not acknowledged. In hold master mode the clock is stretched until
+  the end of the conversion after the delay requested by the library.
+  - Binary words of temperature and relative humidity vary by a sample counter
+  incremented after reading humidity, so that pairs of a sample are unique.
+  - Each transaction can spend the time of its bytes on the bus including
+  address bytes, and can be logged with the time and the identifier.
+  - Message level methods write() and read() serve transports of other
+  layers, e.g., a userspace fake of a Linux i2c-dev device.
+
+  LICENSE:
+  This program is free software; you can redistribute it and/or modify it under
+  the terms of the MIT License (MIT).
+
+  CREDENTIALS:
+  Author: Libor Gabaj
+*/
+#ifndef GBJ_HTU21_EMULATED_H
+#define GBJ_HTU21_EMULATED_H
+
+#include "gbj_twowire.h"
+
+class gbj_htu21_emulated : public gbj_twowire_transport
+{
+public:
+  gbj_htu21_emulated(uint8_t id = 0)
+    : id_(id)
+    , logging_(false)
+    , byteTime_(0)
+    , tempWord_(0x6660)
+    , rhumWord_(0x7C80)
+    , variants_(16)
+    , counter_(0)
+    , command_(0)
+    , userReg_(0x02)
+    , ready_(0){};
+
+  ResultCodes send(uint8_t address, const uint8_t *data, uint8_t dataLen);
+  ResultCodes receive(uint8_t address,
+                      const uint8_t *command,
+                      uint8_t commandLen,
+                      uint32_t delay,
+                      uint8_t *data,
+                      uint8_t dataLen);
+
+  /*
+    Write and read message.
+
+    DESCRIPTION:
+    The method write() takes a command with its data bytes. The method read()
+    provides response bytes to the recent command and returns false for not
+    acknowledged address, i.e., for not finished conversion without clock
+    stretching or without any command to respond.
+
+    PARAMETERS:
+    data - Pointer to bytes of the message.
+      - Data type: pointer
+      - Default value: none
+      - Limited range: none
+
+    dataLen - Number of bytes of the message.
+      - Data type: non-negative integer
+      - Default value: none
+      - Limited range: 0 ~ 255
+
+    stretch - Flag about stretching the clock in hold master mode until the
+    end of the conversion.
+      - Data type: bool
+      - Default value: none
+      - Limited range: true, false
+
+    RETURN: Flag about acknowledged message
+  */
+  bool write(const uint8_t *data, uint8_t dataLen);
+  bool read(uint8_t *data, uint8_t dataLen, bool stretch);
+
+  // Setters
+  inline void setLogging(bool logging) { logging_ = logging; }
+  // Bus time per byte including acknowledge in microseconds, e.g., 90 at
+  // 100 kHz, zero for no time
+  inline void setByteTime(uint16_t byteTime) { byteTime_ = byteTime; }
+  // Binary words of the first sample and number of distinct samples
+  inline void setWords(uint16_t temp, uint16_t rhum, uint16_t variants)
+  {
+    tempWord_ = temp;
+    rhumWord_ = rhum;
+    variants_ = variants ? variants : 1;
+  }
+
+  // Getters
+  inline uint8_t getUserRegister() { return userReg_; }
+  // Resolution code from RES1 (D7) and RES0 (D0) bits of user register
+  inline uint8_t getResolution()
+  {
+    return (((userReg_ >> 7) & 1) << 1) | (userReg_ & 1);
+  }
+
+private:
+  enum Params : uint8_t
+  {
+    // Address of the sensor
+    PARAM_ADDRESS = 0x40,
+  };
+  uint8_t id_;
+  bool logging_;
+  uint16_t byteTime_;
+  uint16_t tempWord_;
+  uint16_t rhumWord_;
+  uint16_t variants_;
+  uint16_t counter_;
+  // Recent command including the second byte of two byte commands
+  uint16_t command_;
+  uint8_t userReg_;
+  // Time of the end of conversion in milliseconds
+  unsigned long ready_;
+
+  inline void transfer(uint8_t bytes)
+  {
+    delayMicroseconds(static_cast<uint32_t>(bytes) * byteTime_);
+  }
+  void log(const char *transaction);
+  uint8_t crc(const uint8_t *data, uint8_t len);
+};
+
+#endif
@@ -0,0 +1,125 @@
+#include "gbj_htu21_group.h"
+
+gbj_htu21_group::ResultCodes gbj_htu21_group::measure(float *temperatures,
+                                                      float *humidities)
+{
+  ResultCodes result = convert(true, temperatures);
+  if (humidities == NULL)
+  {
+    return result;
+  }
+  if (result == gbj_htu21::ResultCodes::SUCCESS)
+  {
+    result = convert(false, humidities);
+  }
+  else
+  {
+    convert(false, humidities);
+  }
+  for (uint8_t i = 0; i < count_; i++)
+  {
+    gbj_htu21 &sensor = *sensors_[i];
+    if (sensor.isSuccess() && temperatures[i] != sensor.getErrorRHT())
+    {
+      humidities[i] = sensor.compensateHumidity(humidities[i], temperatures[i]);
+    }
+  }
+  return result;
+}
+
+gbj_htu21_group::ResultCodes gbj_htu21_group::convert(bool isTemperature,
+                                                      float *values)
+{
+  // Bit masks of sensors to be triggered and being converted
+  uint8_t todo = (1 << count_) - 1;
+  uint8_t pending;
+  for (uint8_t retry = 0; todo; retry++)
+  {
+    uint8_t timeConversion = 0;
+    uint8_t timeConversionMax = 0;
+    pending = 0;
+    for (uint8_t i = 0; i < count_; i++)
+    {
+      if (!(todo & (1 << i)))
+      {
+        continue;
+      }
+      gbj_htu21 &sensor = *sensors_[i];
+      values[i] = sensor.getErrorRHT();
+      if (retry >= sensor.getRetries())
+      {
+        todo &= ~(1 << i);
+        continue;
+      }
+      if (sensor.isError(isTemperature ? sensor.triggerTemperature()
+                                       : sensor.triggerHumidity()))
+      {
+        todo &= ~(1 << i);
+        continue;
+      }
+      pending |= 1 << i;
+      uint8_t code = sensor.getResolution();
+      uint8_t time = isTemperature ? sensor.getConversionTimeTemp()
+                                   : sensor.getConversionTimeRhum();
+      uint8_t timeMax = isTemperature
+                          ? sensor.getConversionTimeTemp(code, false)
+                          : sensor.getConversionTimeRhum(code, false);
+      timeConversion = time > timeConversion ? time : timeConversion;
+      timeConversionMax = timeMax > timeConversionMax ? timeMax
+                                                      : timeConversionMax;
+    }
+    if (!pending)
+    {
+      break;
+    }
+    delay(timeConversion);
+    // Poll all pending sensors, at most for maximal conversion time
+    uint8_t polls = timeConversionMax;
+    while (pending)
+    {
+      for (uint8_t i = 0; i < count_; i++)
+      {
+        if (!(pending & (1 << i)))
+        {
+          continue;
+        }
+        gbj_htu21 &sensor = *sensors_[i];
+        switch (sensor.fetchMeasurement(values[i]))
+        {
+          case gbj_htu21::ResultCodes::ERROR_RCV_DATA:
+            // Conversion not finished yet
+            if (polls == 0)
+            {
+              pending &= ~(1 << i);
+              todo &= ~(1 << i);
+            }
+            break;
+
+          case gbj_htu21::ResultCodes::ERROR_MEASURE:
+            // Wrong CRC or status bits, trigger again
+            pending &= ~(1 << i);
+            break;
+
+          default:
+            pending &= ~(1 << i);
+            todo &= ~(1 << i);
+            break;
+        }
+      }
+      if (pending)
+      {
+        polls--;
+        delay(Timing::TIMING_POLL);
+      }
+    }
+  }
+  // First failed sensor
+  for (uint8_t i = 0; i < count_; i++)
+  {
+    if (sensors_[i]->isError())
+    {
+      return sensors_[i]->getLastResult();
+    }
+  }
+  return gbj_htu21::ResultCodes::SUCCESS;
+}
@@ -0,0 +1,135 @@
+/*
+  NAME:
+  gbjHTU21Group
+
+  DESCRIPTION:
+  Parallel acquisition from a group of sensors HTU21D(F), SHT21, SHT20, HDC1080
+  driven by the library gbjHTU21, each on its own two-wire bus due to the fixed
+  address of the sensor.
+  - Conversions are triggered on all sensors at once in no hold master mode and
+  results are collected afterwards, so that the conversion times of all sensors
+  overlap and the group takes about the time of a single sensor.
+  - Each instance needs its own transport of the host emulation of the library
+  gbjTwoWire, e.g., gbj_twowire_linux on distinct adapters /dev/i2c-N of
+  a Linux computer. The class is not part of the library for microcontrollers,
+  where gbjTwoWire drives a single bus controller and the pins of the
+  constructor do not select another hardware bus.
+
+  LICENSE:
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the MIT License (MIT).
+
+  CREDENTIALS:
+  Author: Libor Gabaj
+  GitHub: https://github.com/mrkaleArduinoLib/gbj_htu21.git
+*/
+#ifndef GBJ_HTU21_GROUP_H
+#define GBJ_HTU21_GROUP_H
+
+#include "gbj_htu21.h"
+
+class gbj_htu21_group
+{
+public:
+  typedef gbj_htu21::ResultCodes ResultCodes;
+
+  enum Params : uint8_t
+  {
+    // Maximal number of sensors in a group
+    PARAM_SENSORS_MAX = 8,
+  };
+
+  /*
+    Constructor.
+
+    DESCRIPTION:
+    The constructor binds the group to an array of sensors provided by a caller
+    without any memory allocation.
+    - Each sensor should be an instance of the library communicating on
+    a distinct two-wire bus, i.e., with its own transport.
+
+    PARAMETERS:
+    sensors - Pointer to an array of pointers to sensor instances.
+      - Data type: pointer
+      - Default value: none
+      - Limited range: none
+
+    count - Number of sensors in the array.
+      - Data type: non-negative integer
+      - Default value: none
+      - Limited range: 0 ~ 8
+
+    RETURN: object
+  */
+  gbj_htu21_group(gbj_htu21 **sensors, uint8_t count)
+    : sensors_(sensors)
+    , count_(count > Params::PARAM_SENSORS_MAX
+               ? static_cast<uint8_t>(Params::PARAM_SENSORS_MAX)
+               : count){};
+
+  /*
+    Measure all sensors.
+
+    DESCRIPTION:
+    The method measures temperature and then relative humidity on all sensors
+    of the group in parallel and compensates humidities by temperatures.
+    - A sensor with failed measurement is repeated up to its number of retries
+    while the other sensors are not measured again.
+    - The result of each sensor is available by its method getLastResult().
+
+    PARAMETERS:
+    temperatures - Pointer to an array for placing temperatures in centigrades
+    of all sensors in the group.
+      - Data type: pointer
+      - Default value: none
+      - Limited range: none
+
+    humidities - Pointer to an array for placing compensated relative
+    humidities in per-cents of all sensors in the group. If it is NULL, only
+    temperatures are measured.
+      - Data type: pointer
+      - Default value: NULL
+      - Limited range: none
+
+    RETURN: Result code of the first failed sensor or SUCCESS
+  */
+  ResultCodes measure(float *temperatures, float *humidities = NULL);
+
+  // Getters
+  inline uint8_t getCount() { return count_; }
+  inline gbj_htu21 &getSensor(uint8_t idx) { return *sensors_[idx]; }
+
+private:
+  enum Timing : uint8_t
+  {
+    // Polling period of finished conversions in milliseconds
+    TIMING_POLL = 1,
+  };
+  gbj_htu21 **sensors_;
+  uint8_t count_;
+
+  /*
+    Convert quantity on all sensors.
+
+    DESCRIPTION:
+    The method triggers conversions on all sensors, waits for the longest
+    conversion time, and polls all sensors until their conversions finish or
+    the longest maximal conversion time elapses.
+
+    PARAMETERS:
+    isTemperature - Flag about measuring temperature instead of humidity.
+      - Data type: bool
+      - Default value: none
+      - Limited range: true, false
+
+    values - Pointer to an array for placing measured values.
+      - Data type: pointer
+      - Default value: none
+      - Limited range: none
+
+    RETURN: Result code of the first failed sensor or SUCCESS
+  */
+  ResultCodes convert(bool isTemperature, float *values);
+};
+
+#endif
@@ -0,0 +1,164 @@
+#include "gbj_twowire.h"
+#include <time.h>
+
+// Virtual time of the current thread in microseconds
+static thread_local uint64_t timeMicros = 0;
+// Flag about using real time in the current thread
+static thread_local bool timeReal = false;
+
+static uint64_t realMicros()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void realSleep(uint64_t us)
+{
+  struct timespec ts;
+  ts.tv_sec = us / 1000000;
+  ts.tv_nsec = (us % 1000000) * 1000;
+  while (nanosleep(&ts, &ts) != 0)
+  {
+  }
+}
+
+unsigned long millis()
+{
+  return static_cast<unsigned long>((timeReal ? realMicros() : timeMicros) /
+                                    1000);
+}
+
+unsigned long micros()
+{
+  return static_cast<unsigned long>(timeReal ? realMicros() : timeMicros);
+}
+
+void delay(unsigned long ms)
+{
+  if (timeReal)
+  {
+    realSleep(static_cast<uint64_t>(ms) * 1000);
+    return;
+  }
+  timeMicros += static_cast<uint64_t>(ms) * 1000;
+}
+
+void delayMicroseconds(unsigned int us)
+{
+  if (timeReal)
+  {
+    realSleep(us);
+    return;
+  }
+  timeMicros += us;
+}
+
+void hostSetMicros(uint64_t us)
+{
+  timeMicros = us;
+}
+
+void hostSetRealTime(bool realTime)
+{
+  timeReal = realTime;
+}
+
+const char *gbj_twowire::getResultTxt(ResultCodes result)
+{
+  switch (result)
+  {
+    case ResultCodes::SUCCESS:
+      return "SUCCESS";
+    case ResultCodes::ERROR_BUFFER:
+      return "ERROR_BUFFER";
+    case ResultCodes::ERROR_ADDR:
+      return "ERROR_ADDR";
+    case ResultCodes::ERROR_NACK_DATA:
+      return "ERROR_NACK_DATA";
+    case ResultCodes::ERROR_NACK_OTHER:
+      return "ERROR_NACK_OTHER";
+    case ResultCodes::ERROR_BUS:
+      return "ERROR_BUS";
+    case ResultCodes::ERROR_PINS:
+      return "ERROR_PINS";
+    case ResultCodes::ERROR_RCV_DATA:
+      return "ERROR_RCV_DATA";
+    case ResultCodes::ERROR_POSITION:
+      return "ERROR_POSITION";
+    case ResultCodes::ERROR_DEVICE:
+      return "ERROR_DEVICE";
+    case ResultCodes::ERROR_FIRMWARE:
+      return "ERROR_FIRMWARE";
+    case ResultCodes::ERROR_SN:
+      return "ERROR_SN";
+    case ResultCodes::ERROR_RESET:
+      return "ERROR_RESET";
+    case ResultCodes::ERROR_REGISTER:
+      return "ERROR_REGISTER";
+    case ResultCodes::ERROR_MEASURE:
+      return "ERROR_MEASURE";
+  }
+  return "ERROR_UNKNOWN";
+}
+
+uint8_t gbj_twowire::commandBytes(uint16_t command, uint8_t *buffer)
+{
+  uint8_t bytes = 0;
+  if (command > 0xFF)
+  {
+    buffer[bytes++] = highByte(command);
+  }
+  buffer[bytes++] = lowByte(command);
+  return bytes;
+}
+
+gbj_twowire::ResultCodes gbj_twowire::busSend(uint16_t command)
+{
+  if (transport_ == NULL)
+  {
+    return setLastResult(ResultCodes::ERROR_ADDR);
+  }
+  uint8_t data[2];
+  uint8_t bytes = commandBytes(command, data);
+  return setLastResult(transport_->send(address_, data, bytes));
+}
+
+gbj_twowire::ResultCodes gbj_twowire::busSend(uint16_t command, uint16_t data)
+{
+  if (transport_ == NULL)
+  {
+    return setLastResult(ResultCodes::ERROR_ADDR);
+  }
+  uint8_t buffer[4];
+  uint8_t bytes = commandBytes(command, buffer);
+  bytes += commandBytes(data, &buffer[bytes]);
+  return setLastResult(transport_->send(address_, buffer, bytes));
+}
+
+gbj_twowire::ResultCodes gbj_twowire::busReceive(uint16_t command,
+                                                 uint8_t *dataArray,
+                                                 uint16_t bytes,
+                                                 uint16_t start)
+{
+  if (transport_ == NULL)
+  {
+    return setLastResult(ResultCodes::ERROR_ADDR);
+  }
+  uint8_t buffer[2];
+  uint8_t commandLen = commandBytes(command, buffer);
+  return setLastResult(transport_->receive(
+    address_, buffer, commandLen, delayReceive_, &dataArray[start], bytes));
+}
+
+gbj_twowire::ResultCodes gbj_twowire::busReceive(uint8_t *dataArray,
+                                                 uint16_t bytes,
+                                                 uint16_t start)
+{
+  if (transport_ == NULL)
+  {
+    return setLastResult(ResultCodes::ERROR_ADDR);
+  }
+  return setLastResult(transport_->receive(
+    address_, NULL, 0, delayReceive_, &dataArray[start], bytes));
+}
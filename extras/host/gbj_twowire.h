@@ -0,0 +1,147 @@
+/*
+  NAME:
+  Host emulation of gbjTwoWire library for gbjHTU21 library.
+
+  DESCRIPTION:
+  The header provides the subset of the interface of the library gbjTwoWire
+  utilized by the library gbjHTU21, so that it can be compiled and run on
+  a host computer.
+  - Bus transactions are delegated to a transport object, e.g., a replay of
+  a captured trace or a Linux i2c-dev device.
+  - Without a transport all transactions fail with ERROR_ADDR.
+
+  LICENSE:
+  This program is free software; you can redistribute it and/or modify it under
+  the terms of the MIT License (MIT).
+
+  CREDENTIALS:
+  Author: Libor Gabaj
+*/
+#ifndef GBJ_TWOWIRE_H
+#define GBJ_TWOWIRE_H
+
+#include "Arduino.h"
+
+class gbj_twowire_transport;
+
+class gbj_twowire
+{
+public:
+  enum ResultCodes : uint8_t
+  {
+    SUCCESS = 0,
+    ERROR_BUFFER = 1,
+    ERROR_ADDR = 2,
+    ERROR_NACK_DATA = 3,
+    ERROR_NACK_OTHER = 4,
+    ERROR_BUS = 5,
+    ERROR_PINS = 6,
+    ERROR_RCV_DATA = 7,
+    ERROR_POSITION = 8,
+    ERROR_DEVICE = 9,
+    ERROR_FIRMWARE = 10,
+    ERROR_SN = 11,
+    ERROR_RESET = 12,
+    ERROR_REGISTER = 13,
+    ERROR_MEASURE = 14,
+  };
+  enum ClockSpeeds : uint32_t
+  {
+    CLOCK_100KHZ = 100000L,
+    CLOCK_400KHZ = 400000L,
+  };
+
+  gbj_twowire(ClockSpeeds clockSpeed = ClockSpeeds::CLOCK_100KHZ,
+              uint8_t pinSDA = 4,
+              uint8_t pinSCL = 5)
+    : transport_(NULL)
+    , address_(0)
+    , clock_(clockSpeed)
+    , delayReceive_(0)
+    , lastResult_(ResultCodes::SUCCESS){};
+
+  inline ResultCodes begin() { return setLastResult(); }
+  inline void release() {}
+
+  // Host specific
+  inline void setTransport(gbj_twowire_transport *transport)
+  {
+    transport_ = transport;
+  }
+  static const char *getResultTxt(ResultCodes result);
+
+  // Result handling
+  inline ResultCodes setLastResult(ResultCodes result = ResultCodes::SUCCESS)
+  {
+    return lastResult_ = result;
+  }
+  inline ResultCodes getLastResult() { return lastResult_; }
+  inline bool isSuccess(ResultCodes result)
+  {
+    return result == ResultCodes::SUCCESS;
+  }
+  inline bool isSuccess() { return isSuccess(lastResult_); }
+  inline bool isError(ResultCodes result) { return !isSuccess(result); }
+  inline bool isError() { return isError(lastResult_); }
+  inline String getLastErrorTxt(String location)
+  {
+    return location + ": " + getResultTxt(lastResult_);
+  }
+
+  // Setters and getters
+  inline ResultCodes setAddress(uint8_t address)
+  {
+    address_ = address;
+    return setLastResult();
+  }
+  inline uint8_t getAddress() { return address_; }
+  inline void setBusClock(ClockSpeeds clockSpeed) { clock_ = clockSpeed; }
+  inline uint32_t getBusClock() { return clock_; }
+  inline void setDelayReceive(uint32_t delay) { delayReceive_ = delay; }
+  inline uint32_t getDelayReceive() { return delayReceive_; }
+
+protected:
+  ResultCodes busSend(uint16_t command);
+  ResultCodes busSend(uint16_t command, uint16_t data);
+  ResultCodes busReceive(uint16_t command,
+                         uint8_t *dataArray,
+                         uint16_t bytes,
+                         uint16_t start = 0);
+  ResultCodes busReceive(uint8_t *dataArray,
+                         uint16_t bytes,
+                         uint16_t start = 0);
+  inline void wait(uint32_t delay) { ::delay(delay); }
+
+private:
+  gbj_twowire_transport *transport_;
+  uint8_t address_;
+  uint32_t clock_;
+  uint32_t delayReceive_;
+  ResultCodes lastResult_;
+  // Split command word to bytes and return their count
+  uint8_t commandBytes(uint16_t command, uint8_t *buffer);
+};
+
+/*
+  Transport of bus transactions on a host.
+  - The method send() writes bytes to the device.
+  - The method receive() writes command bytes, if there are any, and reads data
+  bytes from the device after the delay in milliseconds.
+*/
+class gbj_twowire_transport
+{
+public:
+  typedef gbj_twowire::ResultCodes ResultCodes;
+  virtual ~gbj_twowire_transport() {}
+  virtual ResultCodes send(uint8_t address,
+                           const uint8_t *data,
+                           uint8_t dataLen) = 0;
+  virtual ResultCodes receive(uint8_t address,
+                              const uint8_t *command,
+                              uint8_t commandLen,
+                              uint32_t delay,
+                              uint8_t *data,
+                              uint8_t dataLen) = 0;
+};
+
+#endif
@@ -0,0 +1,105 @@
+#include "gbj_twowire_linux.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/i2c-dev.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+bool gbj_twowire_linux::open(const char *device)
+{
+  close();
+  fd_ = ::open(device, O_RDWR);
+  transfers_ = 0;
+  return fd_ >= 0;
+}
+
+void gbj_twowire_linux::close()
+{
+  if (fd_ >= 0)
+  {
+    ::close(fd_);
+    fd_ = -1;
+  }
+}
+
+gbj_twowire_linux::ResultCodes gbj_twowire_linux::send(uint8_t address,
+                                                       const uint8_t *data,
+                                                       uint8_t dataLen)
+{
+  struct i2c_msg msg;
+  msg.addr = address;
+  msg.flags = 0;
+  msg.len = dataLen;
+  msg.buf = const_cast<uint8_t *>(data);
+  return execute(&msg, 1, false);
+}
+
+gbj_twowire_linux::ResultCodes gbj_twowire_linux::receive(
+  uint8_t address,
+  const uint8_t *command,
+  uint8_t commandLen,
+  uint32_t delay,
+  uint8_t *data,
+  uint8_t dataLen)
+{
+  struct i2c_msg msgs[2];
+  uint8_t msgsLen = 0;
+  if (commandLen > 0)
+  {
+    msgs[msgsLen].addr = address;
+    msgs[msgsLen].flags = 0;
+    msgs[msgsLen].len = commandLen;
+    msgs[msgsLen].buf = const_cast<uint8_t *>(command);
+    msgsLen++;
+    // Without clock stretching wait for the sensor between transfers
+    if (delay > 0 && !clockStretching_)
+    {
+      ResultCodes result = execute(msgs, msgsLen, false);
+      if (result != ResultCodes::SUCCESS)
+      {
+        return result;
+      }
+      ::delay(delay);
+      msgsLen = 0;
+    }
+  }
+  msgs[msgsLen].addr = address;
+  msgs[msgsLen].flags = I2C_M_RD;
+  msgs[msgsLen].len = dataLen;
+  msgs[msgsLen].buf = data;
+  msgsLen++;
+  return execute(msgs, msgsLen, commandLen == 0);
+}
+
+int gbj_twowire_linux::transfer(struct i2c_msg *msgs, uint8_t msgsLen)
+{
+  struct i2c_rdwr_ioctl_data rdwr;
+  rdwr.msgs = msgs;
+  rdwr.nmsgs = msgsLen;
+  return ioctl(fd_, I2C_RDWR, &rdwr) < 0 ? errno : 0;
+}
+
+gbj_twowire_linux::ResultCodes gbj_twowire_linux::execute(
+  struct i2c_msg *msgs,
+  uint8_t msgsLen,
+  bool polling)
+{
+  transfers_++;
+  switch (transfer(msgs, msgsLen))
+  {
+    case 0:
+      return ResultCodes::SUCCESS;
+
+    // Not acknowledged address
+    case ENXIO:
+    case EREMOTEIO:
+      return polling ? ResultCodes::ERROR_RCV_DATA : ResultCodes::ERROR_ADDR;
+
+    case EBADF:
+    case ENODEV:
+      return ResultCodes::ERROR_PINS;
+
+    default:
+      return ResultCodes::ERROR_BUS;
+  }
+}
@@ -0,0 +1,89 @@
+/*
+  NAME:
+  Linux i2c-dev transport of gbjTwoWire host emulation for gbjHTU21 library.
+
+  DESCRIPTION:
+  The transport performs bus transactions of the library on a real two-wire
+  bus of a Linux computer through the userspace device /dev/i2c-N.
+  - Writing a command and reading data is done by one I2C_RDWR ioctl with
+  repeated start, so that a sample costs one system call per transaction.
+  - In hold master mode the sensor stretches the clock during conversion
+  within the combined transaction, so that the delay of the library is not
+  waited by default. If a bus adapter does not support long clock stretching,
+  it can be switched off and the command and reading are done by separate
+  transfers with the delay between them.
+  - Polling of a finished conversion is one read only transfer. A not
+  acknowledged address is reported as ERROR_RCV_DATA, so that the library
+  polls again after its polling period.
+  - All transfers go through the virtual method transfer(), which can be
+  overridden by a userspace fake of a sensor for testing without hardware.
+  - Time of the current thread should be switched to real time by
+  hostSetRealTime(true) when talking to a real device.
+
+  LICENSE:
+  This program is free software; you can redistribute it and/or modify it under
+  the terms of the MIT License (MIT).
+
+  CREDENTIALS:
+  Author: Libor Gabaj
+*/
+#ifndef GBJ_TWOWIRE_LINUX_H
+#define GBJ_TWOWIRE_LINUX_H
+
+#include "gbj_twowire.h"
+#include <linux/i2c.h>
+
+class gbj_twowire_linux : public gbj_twowire_transport
+{
+public:
+  gbj_twowire_linux()
+    : fd_(-1)
+    , clockStretching_(true)
+    , transfers_(0){};
+  virtual ~gbj_twowire_linux() { close(); }
+
+  /*
+    Open bus device.
+
+    PARAMETERS:
+    device - Path to the bus device, e.g., "/dev/i2c-1".
+
+    RETURN: Flag about success
+  */
+  bool open(const char *device);
+  void close();
+
+  ResultCodes send(uint8_t address, const uint8_t *data, uint8_t dataLen);
+  ResultCodes receive(uint8_t address,
+                      const uint8_t *command,
+                      uint8_t commandLen,
+                      uint32_t delay,
+                      uint8_t *data,
+                      uint8_t dataLen);
+
+  // Setters and getters
+  inline void setClockStretching(bool enabled) { clockStretching_ = enabled; }
+  inline bool getClockStretching() { return clockStretching_; }
+  // Number of transfers, i.e., system calls, since opening
+  inline unsigned long getTransfers() { return transfers_; }
+
+protected:
+  /*
+    Perform combined transfer.
+
+    DESCRIPTION:
+    The method executes messages as one transfer with repeated starts between
+    them and returns zero at success or the error number of the failure, e.g.,
+    ENXIO or EREMOTEIO for not acknowledged address.
+  */
+  virtual int transfer(struct i2c_msg *msgs, uint8_t msgsLen);
+
+private:
+  int fd_;
+  bool clockStretching_;
+  unsigned long transfers_;
+
+  ResultCodes execute(struct i2c_msg *msgs, uint8_t msgsLen, bool polling);
+};
+
+#endif
@@ -1,135 +1,640 @@
 #include "gbj_htu21.h"
 
-float gbj_htu21::readTemperature()
+// Lookup tables generated and checked by extras/gbj_htu21_tables
+
+/* Natural logarithm of relative humidity 1 ~ 100 % in steps of 1 %, scaled by
+  4096, i.e., round(ln(RH / 100) * 4096).
+*/
+static const int16_t LOG_RHUM[] PROGMEM = {
+  -18863, -16024, -14363, -13185, -12271, -11524, -10892, -10345, -9863, -9431,
+  -9041,  -8685,  -8357,  -8053,  -7771,  -7506,  -7258,  -7024,  -6802, -6592,
+  -6392,  -6202,  -6020,  -5845,  -5678,  -5518,  -5363,  -5214,  -5070, -4931,
+  -4797,  -4667,  -4541,  -4419,  -4300,  -4185,  -4072,  -3963,  -3857, -3753,
+  -3652,  -3553,  -3457,  -3363,  -3271,  -3181,  -3093,  -3006,  -2922, -2839,
+  -2758,  -2678,  -2600,  -2524,  -2449,  -2375,  -2302,  -2231,  -2161, -2092,
+  -2025,  -1958,  -1892,  -1828,  -1764,  -1702,  -1640,  -1580,  -1520, -1461,
+  -1403,  -1346,  -1289,  -1233,  -1178,  -1124,  -1071,  -1018,  -966,  -914,
+  -863,   -813,   -763,   -714,   -666,   -618,   -570,   -524,   -477,  -432,
+  -386,   -342,   -297,   -253,   -210,   -167,   -125,   -83,    -41,   0,
+};
+
+/* Saturation vapour density in mg/m3 for temperature -40 ~ 126 centigrades in
+  steps of 2 centigrades, i.e., round(216.74 * 6.112 * exp(17.62 * T /
+  (243.12 + T)) / (273.15 + T) * 1000).
+*/
+static const uint32_t VAPOUR_DENSITY[] PROGMEM = {
+  177,     215,     261,     316,     380,     456,     545,     650,
+  772,     914,     1078,    1269,    1489,    1742,    2032,    2364,
+  2743,    3175,    3665,    4221,    4850,    5559,    6357,    7254,
+  8260,    9385,    10641,   12041,   13599,   15329,   17246,   19368,
+  21711,   24296,   27141,   30269,   33703,   37466,   41583,   46083,
+  50992,   56342,   62164,   68490,   75357,   82800,   90858,   99572,
+  108982,  119133,  130072,  141845,  154503,  168098,  182682,  198314,
+  215050,  232950,  252079,  272499,  294278,  317486,  342193,  368474,
+  396404,  426061,  457527,  490885,  526219,  563618,  603172,  644972,
+  689114,  735694,  784813,  836571,  891074,  948426,  1008738, 1072120,
+  1138685, 1208549, 1281830, 1358647,
+};
+
+bool gbj_htu21::service()
 {
-  uint8_t data[3];
-  for (uint8_t i = 0; i < Params::PARAM_CRC_CHECKS; i++)
+  switch (begin_.state)
   {
-    if (getHoldMasterMode())
-    {
-      setDelayReceive(getConversionTimeTempMax());
-      if (isError(busReceive(Commands::CMD_MEASURE_TEMP_HOLD,
-                             data,
-                             sizeof(data) / sizeof(data[0]))))
+    case BeginStates::BEGIN_RESET:
+      if (millis() - begin_.timestamp < Timing::TIMING_RESET)
       {
-        break;
+        return true;
       }
-    }
-    else
-    {
-      setDelayReceive(0);
-      while (busReceive(Commands::CMD_MEASURE_TEMP_NOHOLD,
-                        data,
-                        sizeof(data) / sizeof(data[0])) ==
-             ResultCodes::ERROR_RCV_DATA)
+      begin_.state = BeginStates::BEGIN_VERIFY;
+      // Fall through - continue with verification
+
+    case BeginStates::BEGIN_VERIFY:
+      // Check user register reset value
+      if (isError(readUserRegister()))
       {
-        wait(getConversionTimeTemp());
-      };
-      if (isError())
+        break;
+      }
+      if (userReg_.value != Resetting::RESET_REG_USER)
       {
+        setLastResult(static_cast<ResultCodes>(ResultCodes::ERROR_RESET));
         break;
       }
+      begin_.state = BeginStates::BEGIN_CONFIGURE;
+      return true;
+
+    case BeginStates::BEGIN_CONFIGURE:
+      // Turn off heater, the serial number is read at the first request
+      setHeaterDisabled();
+      break;
+
+    case BeginStates::BEGIN_DONE:
+      return false;
+  }
+  begin_.state = BeginStates::BEGIN_DONE;
+  return false;
+}
+
+void gbj_htu21::publishSample(float temperature, float humidity, bool stale)
+{
+  uint32_t timestamp = millis();
+  if (stale)
+  {
+    // Oldest of recent valid words
+    timestamp = timestamp - words_.tempTime > timestamp - words_.rhumTime
+                  ? words_.tempTime
+                  : words_.rhumTime;
+  }
+  // Odd sequence marks publishing in progress
+  publication_.sequence = publication_.sequence + 1;
+  __sync_synchronize();
+  publication_.sample.temperature = temperature;
+  publication_.sample.humidity = humidity;
+  publication_.sample.timestamp = timestamp;
+  publication_.sample.stale = stale;
+  publication_.published = true;
+  __sync_synchronize();
+  publication_.sequence = publication_.sequence + 1;
+}
+
+bool gbj_htu21::getSample(Sample &sample)
+{
+  for (uint8_t i = 0; i < Params::PARAM_SAMPLE_ATTEMPTS; i++)
+  {
+    uint32_t sequence = publication_.sequence;
+    __sync_synchronize();
+    if (sequence & 1)
+    {
+      continue;
     }
-    // Test status bits (last 2 from LSB) and CRC, calculate without status bits
-    if ((data[1] & B11) == B00 && checkCrc8(data))
+    bool published = publication_.published;
+    sample = publication_.sample;
+    __sync_synchronize();
+    if (sequence == publication_.sequence)
     {
-      return calculateTemperature((data[0] << 8) | (data[1] & 0xFC));
+      return published;
     }
   }
-  setLastResult(isSuccess() ? ResultCodes::ERROR_MEASURE : getLastResult());
-  return getErrorRHT();
+  return false;
 }
 
-float gbj_htu21::readHumidity()
+gbj_htu21::ResultCodes gbj_htu21::triggerMeasurement(bool isTemperature)
+{
+  setDelayReceive(0);
+  status_.pendingTemp = isTemperature;
+  return busSend(isTemperature ? Commands::CMD_MEASURE_TEMP_NOHOLD
+                               : Commands::CMD_MEASURE_RH_NOHOLD);
+}
+
+gbj_htu21::ResultCodes gbj_htu21::fetchWord(uint16_t &wordMeasure)
 {
   uint8_t data[3];
-  for (uint8_t i = 0; i < Params::PARAM_CRC_CHECKS; i++)
+  setDelayReceive(0);
+  if (isError(busReceive(data, sizeof(data) / sizeof(data[0]))))
+  {
+    return getLastResult();
+  }
+  if (!storeWord(status_.pendingTemp, data, wordMeasure))
+  {
+    return setLastResult(ResultCodes::ERROR_MEASURE);
+  }
+  return getLastResult();
+}
+
+bool gbj_htu21::storeWord(bool isTemperature,
+                          const uint8_t *data,
+                          uint16_t &wordMeasure)
+{
+  // Test status bits (last 2 from LSB) and CRC, calculate without status bits
+  if ((data[1] & B11) != (isTemperature ? B00 : B10) || !checkCrc8(data))
+  {
+    return false;
+  }
+  wordMeasure = (data[0] << 8) | (data[1] & 0xFC);
+  // Look up calibration once after initialization or swapping the probe, its
+  // failure is available by getCalibrationResult()
+  if (calibration_.table != NULL && calibration_.pending)
+  {
+    ResultCodes result = getLastResult();
+    lookupCalibration();
+    setLastResult(result);
+  }
+  if (calibration_.found)
+  {
+    wordMeasure = correctWord(
+      wordMeasure, isTemperature ? calibration_.temp : calibration_.rhum);
+  }
+  if (isTemperature)
+  {
+    words_.temp = wordMeasure;
+    words_.tempValid = true;
+    words_.tempTime = millis();
+  }
+  else
+  {
+    words_.rhum = wordMeasure;
+    words_.rhumValid = true;
+    words_.rhumTime = millis();
+  }
+  return true;
+}
+
+gbj_htu21::ResultCodes gbj_htu21::readMeasurement(bool isTemperature,
+                                                   uint16_t &wordMeasure)
+{
+  status_.stale = false;
+  for (uint8_t i = 0; i < getRetries(); i++)
   {
     if (getHoldMasterMode())
     {
-      setDelayReceive(getConversionTimeRhumMax());
-      if (isError(busReceive(Commands::CMD_MEASURE_RH_HOLD,
+      uint8_t data[3];
+      setDelayReceive(isTemperature ? getConversionTimeTempMax()
+                                    : getConversionTimeRhumMax());
+      if (isError(busReceive(isTemperature ? Commands::CMD_MEASURE_TEMP_HOLD
+                                           : Commands::CMD_MEASURE_RH_HOLD,
                              data,
                              sizeof(data) / sizeof(data[0]))))
       {
         break;
       }
+      if (storeWord(isTemperature, data, wordMeasure))
+      {
+        health_.failures = 0;
+        return getLastResult();
+      }
     }
     else
     {
-      setDelayReceive(0);
-      while (busReceive(Commands::CMD_MEASURE_RH_NOHOLD,
-                        data,
-                        sizeof(data) / sizeof(data[0])) ==
-             ResultCodes::ERROR_RCV_DATA)
+      // Trigger conversion just once
+      if (isError(triggerMeasurement(isTemperature)))
       {
-        wait(getConversionTimeRhum());
+        break;
+      }
+      wait(isTemperature ? getConversionTimeTemp() : getConversionTimeRhum());
+      // Poll by read only transactions, at most for maximal conversion time
+      uint8_t polls = isTemperature ? getConversionTimeTempMax()
+                                    : getConversionTimeRhumMax();
+      while (fetchWord(wordMeasure) == ResultCodes::ERROR_RCV_DATA && polls--)
+      {
+        wait(Timing::TIMING_POLL);
       };
-      if (isError())
+      if (isSuccess())
+      {
+        health_.failures = 0;
+        return getLastResult();
+      }
+      // Repeat conversion at wrong CRC or status bits only
+      if (getLastResult() != ResultCodes::ERROR_MEASURE)
       {
         break;
       }
     }
-    // Test status bits (last 2 from LSB) and CRC, calculate without status bits
-    if ((data[1] & B11) == B10 && checkCrc8(data))
+  }
+  ResultCodes result =
+    isSuccess() ? ResultCodes::ERROR_MEASURE : getLastResult();
+  // Recover the sensor after too many consecutive failures
+  if (health_.threshold && ++health_.failures >= health_.threshold)
+  {
+    recover();
+  }
+  // Substitute failed measurement by recent valid one
+  if (getStaleEnabled() &&
+      (isTemperature ? words_.tempValid : words_.rhumValid))
+  {
+    wordMeasure = isTemperature ? words_.temp : words_.rhum;
+    status_.stale = true;
+    return setLastResult(ResultCodes::SUCCESS);
+  }
+  return setLastResult(result);
+}
+
+gbj_htu21::ResultCodes gbj_htu21::recover()
+{
+  health_.failures = 0;
+  health_.recoveries++;
+  health_.swapped = false;
+  // Configuration bits to be kept: RES1 (D7), HTRE (D2), RES0 (D0)
+  uint8_t config = userReg_.value & B10000101;
+  // Re-probe the sensor by reading user register
+  health_.level = HealthLevels::HEALTH_PROBE;
+  if (isSuccess(readUserRegister()) && ((userReg_.value >> 6) & B1) == 0 &&
+      (userReg_.value & B10000101) == config)
+  {
+    return checkSerialNumber();
+  }
+  // Soft reset
+  health_.level = HealthLevels::HEALTH_RESET;
+  if (isError(reset()))
+  {
+    return getLastResult();
+  }
+  // Restore configuration from cached user register
+  if ((userReg_.value & B10000101) != config)
+  {
+    health_.level = HealthLevels::HEALTH_RESTORE;
+    if (isError(setBitResolution(config & B10000000, config & B00000001)))
     {
-      return calculateHumidity((data[0] << 8) | (data[1] & 0xFC));
+      return getLastResult();
+    }
+    if (isError(setHeaterStatus(config & B00000100)))
+    {
+      return getLastResult();
     }
   }
-  setLastResult(isSuccess() ? ResultCodes::ERROR_MEASURE : getLastResult());
-  return getErrorRHT();
+  return checkSerialNumber();
 }
 
-gbj_htu21::ResultCodes gbj_htu21::readSerialNumber()
+gbj_htu21::ResultCodes gbj_htu21::checkSerialNumber()
 {
-  setDelayReceive(0);
-  // Ask for SNB bytes
+  if (!status_.serialRead)
+  {
+    return getLastResult();
+  }
+  // SNB bytes are unique for each probe unlike SNA and SNC bytes
+  uint32_t serialSNB = status_.serialSNB;
+  if (isError(readSerialSNB()))
+  {
+    status_.serialSNB = serialSNB;
+    return getLastResult();
+  }
+  if (status_.serialSNB != serialSNB)
+  {
+    // Another probe, read its serial number at the next request
+    health_.swapped = true;
+    status_.serialRead = false;
+    words_.tempValid = words_.rhumValid = false;
+    calibration_.found = false;
+    calibration_.pending = true;
+  }
+  return getLastResult();
+}
+
+gbj_htu21::ResultCodes gbj_htu21::probeBusClock()
+{
+  // Bus clocks ordered from the fastest one
+  const ClockSpeeds clocks[] = {
+    ClockSpeeds::CLOCK_400KHZ,
+    ClockSpeeds::CLOCK_100KHZ,
+  };
+  link_.monitoring = false;
+  uint8_t errors = 0;
+  for (uint8_t i = 0; i < sizeof(clocks) / sizeof(clocks[0]); i++)
   {
-    uint8_t data[8];
-    // Read and validate 4 SNB bytes of serial number including CRCs
-    if (isError(busReceive(
-          Commands::CMD_READ_SNB, data, sizeof(data) / sizeof(data[0]))))
+    setBusClock(clocks[i]);
+    errors = 0;
+    for (uint8_t j = 0; j < Params::PARAM_LINK_PROBES; j++)
     {
-      return setLastResult(ResultCodes::ERROR_SN);
+      errors += probeLink();
     }
-    status_.serialSNB = 0x00000000;
-    /* From SNB_3 to SNB_0.
-      After each SNB byte the CRC byte follows, i.e., there are 4 pairs of
-      SNB-CRC bytes. Each SNB byte is CRC checked separately.
-    */
-    for (uint8_t i = 0; i < (sizeof(data) / sizeof(data[0]) / 2); i++)
+    if (errors == 0)
     {
-      status_.serialSNB <<= 8;
-      status_.serialSNB |= data[2 * i];
-      if (!checkCrc8(&data[2 * i], 1))
-      {
-        return setLastResult(ResultCodes::ERROR_SN);
-      }
+      break;
     }
   }
-  // Ask for SNC, SNA bytes
+  link_.windowChecks = link_.windowErrors = 0;
+  link_.monitoring = true;
+  return setLastResult(errors ? ResultCodes::ERROR_BUS : ResultCodes::SUCCESS);
+}
+
+uint8_t gbj_htu21::probeLink()
+{
+  uint8_t errors = 0;
+  uint8_t data[8];
+  setDelayReceive(0);
+  // Serial number bytes, each of SNB bytes with its own CRC
+  if (isError(busReceive(Commands::CMD_READ_SNB, data, 8)))
+  {
+    errors++;
+  }
+  else
   {
-    // Read and validate 2 SNC and 2 SNA bytes of serial number including CRC
-    uint8_t data[6];
-    if (isError(busReceive(
-          Commands::CMD_READ_SNAC, data, sizeof(data) / sizeof(data[0]))))
+    for (uint8_t i = 0; i < 4; i++)
     {
-      return setLastResult(ResultCodes::ERROR_SN);
+      errors += checkCrc8(&data[2 * i], 1) ? 0 : 1;
     }
-    /* From SNC to SNA
-      After each pair of SNC and SNA bytes the CRC byte follows, i.e., there
-      are 2 byte tripples: SNC1-SNC0-CRC, SNA1-SNA0-CRC.
-    */
-    status_.serialSNC = (data[0] << 8) | data[1];
-    if (!checkCrc8(data))
+  }
+  if (isError(busReceive(Commands::CMD_READ_SNAC, data, 6)))
+  {
+    errors++;
+  }
+  else
+  {
+    errors += checkCrc8(data) ? 0 : 1;
+    errors += checkCrc8(&data[3]) ? 0 : 1;
+  }
+  // User register without CRC compared to the cached value in bits written
+  // by the driver (resolution and heater), the other bits are status or
+  // reserved ones changed by the sensor itself
+  if (isError(busReceive(Commands::CMD_REG_RHT_READ, data, 1)) ||
+      (userReg_.read &&
+       (data[0] & B10000101) != (userReg_.value & B10000101)))
+  {
+    errors++;
+  }
+  return errors;
+}
+
+void gbj_htu21::monitorLink(bool valid)
+{
+  link_.checks++;
+  if (!valid)
+  {
+    link_.errors++;
+    link_.windowErrors++;
+  }
+  if (link_.monitoring && link_.windowErrors >= Params::PARAM_LINK_ERRORS &&
+      getBusClock() > ClockSpeeds::CLOCK_100KHZ)
+  {
+    setBusClock(ClockSpeeds::CLOCK_100KHZ);
+    link_.stepDowns++;
+    link_.windowChecks = link_.windowErrors = 0;
+    return;
+  }
+  if (++link_.windowChecks >= Params::PARAM_LINK_WINDOW)
+  {
+    link_.windowChecks = link_.windowErrors = 0;
+  }
+}
+
+gbj_htu21::ResultCodes gbj_htu21::lookupCalibration()
+{
+  calibration_.found = false;
+  calibration_.pending = false;
+  if (calibration_.table == NULL)
+  {
+    return calibration_.result = getLastResult();
+  }
+  if (isError(reloadSerialNumber()))
+  {
+    return calibration_.result = getLastResult();
+  }
+  uint64_t serial = getSerialNumber();
+  // Bisection of the table sorted by serial numbers
+  uint16_t low = 0;
+  uint16_t high = calibration_.count;
+  while (low < high)
+  {
+    uint16_t mid = low + (high - low) / 2;
+    Calibration record;
+    memcpy_P(&record, &calibration_.table[mid], sizeof(record));
+    if (record.serial < serial)
     {
-      return setLastResult(ResultCodes::ERROR_SN);
+      low = mid + 1;
     }
-    status_.serialSNA = (data[3] << 8) | data[4];
-    if (!checkCrc8(&data[3]))
+    else if (record.serial > serial)
+    {
+      high = mid;
+    }
+    else
+    {
+      calibration_.temp = record.temp;
+      calibration_.rhum = record.rhum;
+      calibration_.found = true;
+      break;
+    }
+  }
+  return calibration_.result = getLastResult();
+}
+
+gbj_htu21::Correction gbj_htu21::calculateCorrection(bool isTemperature,
+                                                     float measured1,
+                                                     float reference1,
+                                                     float measured2,
+                                                     float reference2)
+{
+  Correction correction = { 16384, 0 };
+  if (measured1 == measured2)
+  {
+    return correction;
+  }
+  // Linear formulas of conversion from binary word
+  float scale = isTemperature ? 175.72 : 125.0;
+  float shift = isTemperature ? 46.85 : 6.0;
+  float word1 = (measured1 + shift) * 65536.0 / scale;
+  float word2 = (measured2 + shift) * 65536.0 / scale;
+  float ref1 = (reference1 + shift) * 65536.0 / scale;
+  float ref2 = (reference2 + shift) * 65536.0 / scale;
+  float gain = (ref2 - ref1) / (word2 - word1);
+  float offset = ref1 - gain * word1;
+  gain = constrain(gain * 16384.0 + 0.5, 0.0, 65535.0);
+  offset = constrain(offset, -32768.0, 32767.0);
+  correction.gain = static_cast<uint16_t>(gain);
+  correction.offset = static_cast<int16_t>(offset < 0 ? offset - 0.5
+                                                      : offset + 0.5);
+  return correction;
+}
+
+float gbj_htu21::readTemperature()
+{
+  uint16_t wordMeasure;
+  if (isError(readMeasurement(true, wordMeasure)))
+  {
+    return getErrorRHT();
+  }
+  return calculateTemperature(wordMeasure);
+}
+
+float gbj_htu21::readHumidity()
+{
+  uint16_t wordMeasure;
+  if (isError(readMeasurement(false, wordMeasure)))
+  {
+    return getErrorRHT();
+  }
+  return calculateHumidity(wordMeasure);
+}
+
+gbj_htu21::ResultCodes gbj_htu21::readSerialNumber()
+{
+  if (isError(readSerialSNB()))
+  {
+    return getLastResult();
+  }
+  return readSerialSNAC();
+}
+
+gbj_htu21::ResultCodes gbj_htu21::readSerialSNB()
+{
+  setDelayReceive(0);
+  uint8_t data[8];
+  // Read and validate 4 SNB bytes of serial number including CRCs
+  if (isError(busReceive(
+        Commands::CMD_READ_SNB, data, sizeof(data) / sizeof(data[0]))))
+  {
+    return setLastResult(ResultCodes::ERROR_SN);
+  }
+  status_.serialSNB = 0x00000000;
+  /* From SNB_3 to SNB_0.
+    After each SNB byte the CRC byte follows, i.e., there are 4 pairs of
+    SNB-CRC bytes. Each SNB byte is CRC checked separately.
+  */
+  for (uint8_t i = 0; i < (sizeof(data) / sizeof(data[0]) / 2); i++)
+  {
+    status_.serialSNB <<= 8;
+    status_.serialSNB |= data[2 * i];
+    if (!checkCrc8(&data[2 * i], 1))
     {
       return setLastResult(ResultCodes::ERROR_SN);
     }
   }
   return getLastResult();
 }
+
+gbj_htu21::ResultCodes gbj_htu21::readSerialSNAC()
+{
+  setDelayReceive(0);
+  // Read and validate 2 SNC and 2 SNA bytes of serial number including CRC
+  uint8_t data[6];
+  if (isError(busReceive(
+        Commands::CMD_READ_SNAC, data, sizeof(data) / sizeof(data[0]))))
+  {
+    return setLastResult(ResultCodes::ERROR_SN);
+  }
+  /* From SNC to SNA
+    After each pair of SNC and SNA bytes the CRC byte follows, i.e., there
+    are 2 byte tripples: SNC1-SNC0-CRC, SNA1-SNA0-CRC.
+  */
+  status_.serialSNC = (data[0] << 8) | data[1];
+  if (!checkCrc8(data))
+  {
+    return setLastResult(ResultCodes::ERROR_SN);
+  }
+  status_.serialSNA = (data[3] << 8) | data[4];
+  if (!checkCrc8(&data[3]))
+  {
+    return setLastResult(ResultCodes::ERROR_SN);
+  }
+  return getLastResult();
+}
+
+gbj_htu21::ResultCodes gbj_htu21::reloadSerialNumber()
+{
+  if (status_.serialRead)
+  {
+    return getLastResult();
+  }
+  /* Validate persisted serial number by SNB bytes only, which are unique for
+    each probe, while SNA and SNC bytes identify the vendor and product.
+  */
+  uint64_t serial;
+  if (serialStore_.loader != NULL && serialStore_.loader(serial))
+  {
+    if (isSuccess(readSerialSNB()) &&
+        status_.serialSNB == static_cast<uint32_t>(serial >> 16))
+    {
+      status_.serialSNA = static_cast<uint16_t>(serial >> 48);
+      status_.serialSNC = static_cast<uint16_t>(serial);
+      status_.serialRead = true;
+      return getLastResult();
+    }
+  }
+  if (isError(readSerialNumber()))
+  {
+    return getLastResult();
+  }
+  status_.serialRead = true;
+  if (serialStore_.saver != NULL)
+  {
+    serialStore_.saver(getSerialNumber());
+  }
+  return getLastResult();
+}
+
+int16_t gbj_htu21::dewPoint(int16_t temperature, uint16_t humidity)
+{
+  // Magnus coefficients b = 17.62 scaled by 4096 and c = 243.12 centigrades
+  const int32_t coefB = 72172;
+  const int32_t coefC = 24312;
+  // Interpolate logarithm of humidity at least 1 %
+  humidity = constrain(humidity, 100, 10000);
+  uint8_t idx = humidity / 100 - 1;
+  int32_t gamma = static_cast<int16_t>(pgm_read_word(&LOG_RHUM[idx]));
+  if (idx < sizeof(LOG_RHUM) / sizeof(LOG_RHUM[0]) - 1)
+  {
+    int32_t next = static_cast<int16_t>(pgm_read_word(&LOG_RHUM[idx + 1]));
+    gamma += (next - gamma) * (humidity % 100) / 100;
+  }
+  gamma += coefB * temperature / (coefC + temperature);
+  return static_cast<int16_t>(coefC * gamma / (coefB - gamma));
+}
+
+int32_t gbj_htu21::absHumidity(int16_t temperature, uint16_t humidity)
+{
+  const uint16_t step = 200;
+  temperature = constrain(temperature, -4000, 12500);
+  uint16_t offset = temperature + 4000;
+  uint8_t idx = offset / step;
+  int32_t density = pgm_read_dword(&VAPOUR_DENSITY[idx]);
+  if (idx < sizeof(VAPOUR_DENSITY) / sizeof(VAPOUR_DENSITY[0]) - 1)
+  {
+    int32_t next = pgm_read_dword(&VAPOUR_DENSITY[idx + 1]);
+    density += (next - density) * (offset % step) / step;
+  }
+  // Density in mg/m3 times humidity in 0.01 % split to stay within 32 bits
+  return (density * (humidity / 10) + density * (humidity % 10) / 10) / 10000;
+}
+
+int16_t gbj_htu21::heatIndex(int16_t temperature, uint16_t humidity)
+{
+  // Fahrenheit in 0.1 degree, humidity in 0.1 %
+  int32_t f = static_cast<int32_t>(constrain(temperature, -4000, 7000)) * 9 /
+                50 +
+              320;
+  int32_t r = humidity / 10;
+  // Steadman's simple formula in 0.0001 Fahrenheit
+  int32_t index = 1100 * f - 103000 + 47 * r;
+  if (index + 1000 * f >= 1600000)
+  {
+    /* Rothfusz regression by Horner scheme in temperature with coefficients
+      polynomial in humidity, scaled stepwise to stay within 32 bits.
+    */
+    // Coefficient at T^2 in 1e-6
+    int32_t coef = (-6837830 + 122874 * r - 199 * r * r / 10) / 1000;
+    // Coefficient at T in 1e-6
+    coef = 2049015 - 224755 * r / 10 + 853 * r * r / 100 + f * coef / 10;
+    // Absolute term in 1e-4
+    index = -423790 + 1014333 * r / 100 - 548 * r * r / 100 +
+            f * (coef / 100) / 10;
+  }
+  index = (index - 320000) / 180;
+  return static_cast<int16_t>(constrain(index, -32767L, 32767L));
+}
@@ -24,6 +24,46 @@
 class gbj_htu21 : public gbj_twowire
 {
 public:
+  enum HealthLevels : uint8_t
+  {
+    // No recovery performed
+    HEALTH_NONE,
+    // Sensor re-probed successfully by reading user register
+    HEALTH_PROBE,
+    // Sensor reset by soft reset command
+    HEALTH_RESET,
+    // Sensor reset and its configuration restored from cached user register
+    HEALTH_RESTORE,
+  };
+  // Two-point correction of a binary word in fixed point
+  struct Correction
+  {
+    // Gain in 1/16384 (Q14), 16384 is no correction
+    uint16_t gain;
+    // Offset in units of the binary word
+    int16_t offset;
+  };
+  // Calibration of a probe identified by its serial number
+  struct Calibration
+  {
+    uint64_t serial;
+    Correction temp;
+    Correction rhum;
+  };
+  // Recently measured sample published for any number of readers
+  struct Sample
+  {
+    // Temperature in centigrades
+    float temperature;
+    // Compensated relative humidity in per-cents
+    float humidity;
+    // Timestamp of the measurement in milliseconds, at stale values the one
+    // of the oldest value in the sample
+    uint32_t timestamp;
+    // Flag about a failed measurement substituted by recent valid value
+    bool stale;
+  };
+
   gbj_htu21(ClockSpeeds clockSpeed = ClockSpeeds::CLOCK_100KHZ,
             uint8_t pinSDA = 4,
             uint8_t pinSCL = 5)
@@ -48,23 +88,68 @@ public:
   */
   inline ResultCodes begin(bool holdMasterMode = true)
   {
-    if (isError(gbj_twowire::begin()))
+    if (isError(initialize(holdMasterMode)))
     {
       return getLastResult();
     }
-    if (isError(setAddress(Addresses::ADDRESS)))
+    return reset();
+  }
+
+  /*
+    Initialize sensor without blocking.
+
+    DESCRIPTION:
+    The method stores input parameters in the same way as the method begin()
+    and starts the reset of the sensor, but returns immediately after sending
+    the reset command.
+    - The initialization continues by the method service(), which should be
+    called repeatedly until it returns false. Each call performs one short
+    step of the initialization and never waits.
+    - The initialization consists of reset, verification of the user register
+    reset value, and configuration of the heater. The serial number is read
+    at the first request in the same way as after the method begin().
+    - Initialization of more sensors or other peripherals can be overlapped by
+    calling their service methods in the same loop.
+
+    PARAMETERS:
+    holdMasterMode - Flag about blocking (holding) serial clock line during
+    measurement.
+      - Data type: boolean
+      - Default value: true
+      - Limited range: true, false
+
+    RETURN: Result code
+  */
+  inline ResultCodes beginAsync(bool holdMasterMode = true)
+  {
+    if (isError(initialize(holdMasterMode)))
     {
       return getLastResult();
     }
-    setUseValuesMax();
-    setHoldMasterMode(holdMasterMode);
-    if (isError(reset()))
+    if (isError(busSend(Commands::CMD_RESET)))
     {
       return getLastResult();
     }
-    return readSerialNumber();
+    begin_.timestamp = millis();
+    begin_.state = BeginStates::BEGIN_RESET;
+    return getLastResult();
   }
 
+  /*
+    Service non-blocking initialization.
+
+    DESCRIPTION:
+    The method performs the next step of the initialization started by the
+    method beginAsync(), if it is due.
+    - The result of the initialization is available by the method
+    getLastResult() after the method returns false.
+
+    PARAMETERS: none
+
+    RETURN: Flag about initialization in progress
+  */
+  bool service();
+
   /*
     Reset sensor.
 
@@ -116,6 +201,9 @@ public:
     temperature on the same time and retrieves it through input parameter.
     - If the temperature argument is used, the humidity is compensated by the
     temperature coefficient.
+    - If the temperature reuse is set by setTempReuse(), the recent valid
+    temperature is used for compensation instead of a new measurement, if it
+    is fresh enough.
 
     PARAMETERS:
     temperature - Referenced variable for placing a temperature value.
@@ -136,22 +224,251 @@ public:
   }
   inline float measureHumidity(float &temperature)
   {
-    temperature = measureTemperature();
-    if (isError())
+    bool stale;
+    float humidity = readSample(temperature, stale);
+    // Failed measurement keeps recent valid sample for readers
+    if (isSuccess())
     {
-      return getErrorRHT();
+      publishSample(temperature, humidity, stale);
     }
-    float humidity = readHumidity();
-    if (isError())
+    return humidity;
+  }
+
+  /*
+    Get published sample.
+
+    DESCRIPTION:
+    The method copies the sample recently measured successfully by the method
+    measureHumidity() with both quantities without any bus communication.
+    - Failed measurements are not published, so that readers keep the recent
+    valid sample and can judge its age by its timestamp.
+    - The sample is published by the measuring task to a slot guarded by
+    a sequence counter (seqlock), so that any number of other tasks or
+    interrupt service routines can read it without locking and without
+    blocking the measuring task.
+    - A copy overlapping with publishing is detected and repeated for limited
+    number of attempts, so that the method never waits indefinitely.
+    - Only one task may measure with the sensor.
+
+    PARAMETERS:
+    sample - Referenced structure for placing the sample.
+      - Data type: Sample
+      - Default value: none
+      - Limited range: none
+
+    RETURN: Flag about consistent copy of a published sample
+  */
+  bool getSample(Sample &sample);
+
+  /*
+    Trigger conversion.
+
+    DESCRIPTION:
+    The particular method triggers conversion of temperature or relative
+    humidity in no hold master mode regardless of the current measuring mode
+    and returns immediately.
+    - The result should be fetched by the method fetchMeasurement() after the
+    conversion time.
+    - Triggering and fetching split measurement to phases, so that other
+    activities, e.g., conversions of other sensors, can run during the
+    conversion.
+
+    PARAMETERS: none
+
+    RETURN: Result code
+  */
+  inline ResultCodes triggerTemperature() { return triggerMeasurement(true); }
+  inline ResultCodes triggerHumidity() { return triggerMeasurement(false); }
+
+  /*
+    Fetch triggered conversion.
+
+    DESCRIPTION:
+    The method reads the result of recently triggered conversion by one read
+    only transaction without repeating the measurement command.
+
+    PARAMETERS:
+    value - Referenced variable for placing the temperature in centigrades or
+    relative humidity in per-cents without temperature compensation.
+      - Data type: float
+      - Default value: none
+      - Limited range: sensor specific
+
+    RETURN: Result code, ERROR_RCV_DATA if the conversion is not finished yet,
+    ERROR_MEASURE at wrong CRC or status bits
+  */
+  inline ResultCodes fetchMeasurement(float &value)
+  {
+    uint16_t wordMeasure;
+    if (isSuccess(fetchWord(wordMeasure)))
     {
-      return humidity;
+      value = status_.pendingTemp
+                ? calculateTemperature(wordMeasure)
+                : sanitizeHumidity(calculateHumidity(wordMeasure));
     }
-    // Temperature compensation
+    return getLastResult();
+  }
+
+  /*
+    Compensate relative humidity.
+
+    DESCRIPTION:
+    The method compensates relative humidity by the temperature coefficient.
+
+    PARAMETERS:
+    humidity - Relative humidity in per-cents.
+      - Data type: float
+      - Default value: none
+      - Limited range: 0.0 ~ 100.0
+
+    temperature - Temperature in centigrades.
+      - Data type: float
+      - Default value: none
+      - Limited range: -40.0 ~ 125.0
+
+    RETURN: Compensated relative humidity in per-cents
+  */
+  inline float compensateHumidity(float humidity, float temperature)
+  {
     humidity += (temperature - 25.0) *
                 static_cast<float>(Params::PARAM_TEMP_COEF) / 1000.0;
     return sanitizeHumidity(humidity);
   }
 
+  /*
+    Calculate derived quantities.
+
+    DESCRIPTION:
+    The particular method calculates dew point temperature, absolute humidity,
+    or heat index from provided temperature and relative humidity.
+    - The methods utilize integer arithmetic with interpolated lookup tables
+    stored in program memory instead of logarithm and exponential functions.
+    - The dew point is calculated by Magnus formula with error up to 0.11 °C
+    for relative humidity above 5 %.
+    - The absolute humidity is calculated from saturation vapour density with
+    relative error up to 0.3 % above 5 g/m3.
+    - The heat index is calculated by NOAA algorithm (Rothfusz regression)
+    without low and high humidity adjustments with error up to 0.4 °C for
+    temperature up to 40 °C.
+
+    PARAMETERS:
+    temperature - Temperature in centigrades.
+      - Data type: float
+      - Default value: none
+      - Limited range: -40.0 ~ 125.0
+
+    humidity - Relative humidity in per-cents.
+      - Data type: float
+      - Default value: none
+      - Limited range: 0.0 ~ 100.0
+
+    RETURN: Dew point in centigrades, absolute humidity in g/m3, or heat index
+    in centigrades
+  */
+  inline float calculateDewPoint(float temperature, float humidity)
+  {
+    return static_cast<float>(
+             dewPoint(centiTemperature(temperature), centiHumidity(humidity))) /
+           100.0;
+  }
+  inline float calculateAbsHumidity(float temperature, float humidity)
+  {
+    return static_cast<float>(absHumidity(centiTemperature(temperature),
+                                          centiHumidity(humidity))) /
+           100.0;
+  }
+  inline float calculateHeatIndex(float temperature, float humidity)
+  {
+    return static_cast<float>(heatIndex(centiTemperature(temperature),
+                                        centiHumidity(humidity))) /
+           100.0;
+  }
+
+  /*
+    Calculate CRC8 checksum.
+
+    DESCRIPTION:
+    The method calculates CRC8 checksum of the sensor with polynom
+    x^8+x^5+x^4+1 and zero initialization for input byte array.
+
+    PARAMETERS:
+    byteArray - Pointer to an array of bytes
+      - Data type: pointer
+      - Default value: none
+      - Limited range: none
+
+    byteCnt - Number of bytes to be checksummed
+      - Data type: non-negative integer
+      - Default value: none
+      - Limited range: 0 ~ 255
+
+    RETURN: CRC8 checksum
+  */
+  inline uint8_t calculateCrc8(const uint8_t *byteArray, uint8_t byteCnt)
+  {
+    uint8_t crc = 0;
+    for (uint8_t i = 0; i < byteCnt; i++)
+    {
+      crc ^= byteArray[i];
+      for (int8_t b = 7; b >= 0; b--)
+      {
+        if (crc & 0x80)
+        {
+          crc = (crc << 1) ^ 0x31;
+        }
+        else
+        {
+          crc = (crc << 1);
+        }
+      }
+    }
+    return crc;
+  }
+
+  /*
+    Recover sensor.
+
+    DESCRIPTION:
+    The method recovers the sensor, e.g., after brown out or reconnecting, with
+    escalating actions without full initialization.
+    - The sensor is re-probed by reading the user register first. If it fails,
+    the supply voltage is low, or the configuration differs from the cached
+    one, the sensor is reset by soft reset command.
+    - After the reset the resolution and heater status are restored from the
+    cached user register.
+    - If the serial number has been read, its SNB bytes, which are unique for
+    each probe, are checked in order to detect a swapped probe. In that case
+    the serial number is read at the next request and recent valid measured
+    values are invalidated.
+    - The method is called automatically by measuring methods after the number
+    of consecutive failed measurements set by setRecoveryThreshold().
+
+    PARAMETERS: none
+
+    RETURN: Result code
+  */
+  ResultCodes recover();
+
+  /*
+    Select bus clock automatically.
+
+    DESCRIPTION:
+    The method probes the link to the sensor at bus clocks from the fastest
+    one, selects the fastest reliable clock, and starts monitoring the link.
+    - At each clock all bytes of the serial number and the user register are
+    read repeatedly. The clock is reliable, if all transactions succeed, all
+    CRC checks pass, and the user register matches the cached value.
+    - Monitoring accounts CRC checks of all measurements and serial number
+    reads. If wrong CRCs reach the limit within a window of checks, the bus
+    clock is stepped down to the next slower one, e.g., at a long cable.
+    - The method can be called again later in order to try faster clocks.
+
+    PARAMETERS: none
+
+    RETURN: Result code, ERROR_BUS if even the slowest clock is not reliable
+  */
+  ResultCodes probeBusClock();
+
   // Setters
   inline void setUseValuesTyp() { status_.useValuesTyp = true; }
   inline void setUseValuesMax() { status_.useValuesTyp = false; }
@@ -181,18 +498,186 @@ public:
   inline ResultCodes setResolutionRhum10() { return setResolutionTemp13(); }
   inline ResultCodes setResolutionRhum11() { return setResolutionTemp11(); }
   inline ResultCodes setResolutionRhum8() { return setResolutionTemp12(); }
+  // Set resolution by resolution code (0 ~ 3) from RES1 and RES0 bits
+  inline ResultCodes setResolution(uint8_t code)
+  {
+    return setBitResolution(code & B10, code & B01);
+  }
   //
   inline void setHoldMasterMode(bool holdMasterMode)
   {
     status_.holdMasterMode = holdMasterMode;
   }
+  // Number of conversions attempted at wrong CRC or status bits
+  inline void setRetries(uint8_t retries)
+  {
+    status_.retries =
+      constrain(retries, 1, static_cast<uint8_t>(Params::PARAM_CRC_CHECKS));
+  }
+  // Return recent valid value flagged as stale at failed measurement
+  inline void setStaleEnabled() { status_.staleEnabled = true; }
+  inline void setStaleDisabled() { status_.staleEnabled = false; }
+  /*
+    Set temperature reuse for compensated humidity.
+
+    DESCRIPTION:
+    The method sets conditions, at which the recent valid temperature is reused
+    for compensation of relative humidity instead of measuring it.
+    - The temperature is reused, if it is younger than the window and it has
+    been reused less than the number of times, which is one less than the
+    refresh rate.
+    - Zero value of a parameter makes its condition always true, both of them
+    zero disable the reuse.
+
+    PARAMETERS:
+    window - Maximal age of reused temperature in milliseconds.
+      - Data type: non-negative integer
+      - Default value: none
+      - Limited range: 0 ~ 65535
+
+    refresh - Measure temperature only at every refresh-th humidity sample.
+      - Data type: non-negative integer
+      - Default value: 0
+      - Limited range: 0 ~ 255
+
+    RETURN: none
+  */
+  inline void setTempReuse(uint16_t window, uint8_t refresh = 0)
+  {
+    tempReuse_.window = window;
+    tempReuse_.refresh = refresh;
+  }
+  // Consecutive failed measurements triggering recovery, 0 disables it
+  inline void setRecoveryThreshold(uint8_t threshold)
+  {
+    health_.threshold = threshold;
+  }
+
+  /*
+    Set persistent storage of serial number.
+
+    DESCRIPTION:
+    The method sets callback functions for loading and saving the serial number
+    from and to a persistent storage, e.g., EEPROM or NVS.
+    - At the first request of the serial number, the loaded serial number is
+    validated by reading SNB bytes, which are unique for each probe, from the
+    sensor in one transaction only. If they do not match or loading fails,
+    the entire serial number is read from the sensor and saved.
+    - The loader should return false, if the storage does not contain a valid
+    serial number, e.g., at wrong checksum.
+
+    PARAMETERS:
+    loader - Pointer to a function loading the serial number.
+      - Data type: SerialLoader
+      - Default value: none
+      - Limited range: function pointer or NULL
+
+    saver - Pointer to a function saving the serial number.
+      - Data type: SerialSaver
+      - Default value: none
+      - Limited range: function pointer or NULL
+
+    RETURN: none
+  */
+  typedef bool (*SerialLoader)(uint64_t &serial);
+  typedef void (*SerialSaver)(uint64_t serial);
+  inline void setSerialStore(SerialLoader loader, SerialSaver saver)
+  {
+    serialStore_.loader = loader;
+    serialStore_.saver = saver;
+  }
+
+  /*
+    Set calibration table.
+
+    DESCRIPTION:
+    The method sets a table of calibrations of probes and looks up the one for
+    the serial number of the connected sensor.
+    - The table should be sorted by serial numbers in ascending order and is
+    searched by bisection, so that it can contain many probes.
+    - The table is read by memcpy_P, so that it should be stored in flash
+    memory by PROGMEM on platforms distinguishing it.
+    - The corrections of the found probe are applied to binary words of
+    measured quantities before calculating their values by integer
+    arithmetic, so that they move with the probe, when it is swapped.
+    - After swapping a probe or initialization, the calibration is looked up
+    again at the next measurement only once, so that a failed reading of the
+    serial number is not repeated at each measurement. Its result code is
+    available by the method getCalibrationResult() and the lookup can be
+    repeated by this method.
+
+    PARAMETERS:
+    table - Pointer to an array of calibrations or NULL for no calibration.
+      - Data type: pointer
+      - Default value: none
+      - Limited range: none
+
+    count - Number of calibrations in the array.
+      - Data type: non-negative integer
+      - Default value: none
+      - Limited range: 0 ~ 65535
+
+    RETURN: Result code of reading the serial number
+  */
+  inline ResultCodes setCalibration(const Calibration *table, uint16_t count)
+  {
+    calibration_.table = table;
+    calibration_.count = count;
+    return lookupCalibration();
+  }
+
+  /*
+    Calculate correction.
+
+    DESCRIPTION:
+    The method calculates the two-point correction of binary words from two
+    pairs of measured and reference values of a quantity.
+
+    PARAMETERS:
+    isTemperature - Flag about correction of temperature instead of humidity.
+      - Data type: bool
+      - Default value: none
+      - Limited range: true, false
+
+    measured1, measured2 - Values measured by the probe in centigrades or
+    per-cents.
+      - Data type: float
+      - Default value: none
+      - Limited range: sensor specific
+
+    reference1, reference2 - Reference values in centigrades or per-cents.
+      - Data type: float
+      - Default value: none
+      - Limited range: sensor specific
+
+    RETURN: Correction or no correction if measured values are equal
+  */
+  Correction calculateCorrection(bool isTemperature,
+                                 float measured1,
+                                 float reference1,
+                                 float measured2,
+                                 float reference2);
 
   // Getters
-  inline uint16_t getSNA() { return status_.serialSNA; }
-  inline uint32_t getSNB() { return status_.serialSNB; }
-  inline uint16_t getSNC() { return status_.serialSNC; }
+  // Serial number is read from the sensor or persistent storage at first call
+  inline uint16_t getSNA()
+  {
+    reloadSerialNumber();
+    return status_.serialSNA;
+  }
+  inline uint32_t getSNB()
+  {
+    reloadSerialNumber();
+    return status_.serialSNB;
+  }
+  inline uint16_t getSNC()
+  {
+    reloadSerialNumber();
+    return status_.serialSNC;
+  }
   inline uint64_t getSerialNumber()
   {
+    reloadSerialNumber();
     uint64_t serial;
     serial = status_.serialSNA;
     serial <<= 32;
@@ -202,6 +687,34 @@ public:
     return serial;
   }
   inline bool getHoldMasterMode() { return status_.holdMasterMode; }
+  inline bool getUseValuesTyp() { return status_.useValuesTyp; };
+  inline uint8_t getRetries() { return status_.retries; }
+  inline bool getStaleEnabled() { return status_.staleEnabled; }
+  // Flag about recent measured value substituted by previous valid one, for
+  // both quantities measured by measureHumidity(temperature) on the same time
+  inline bool getStale() { return status_.stale; }
+  inline uint16_t getTempReuseWindow() { return tempReuse_.window; }
+  inline uint8_t getTempReuseRefresh() { return tempReuse_.refresh; }
+  // Number of recent humidity samples compensated by reused temperature
+  inline uint8_t getTempReused() { return tempReuse_.reused; }
+  inline uint8_t getRecoveryThreshold() { return health_.threshold; }
+  // Number of consecutive failed measurements
+  inline uint8_t getFailures() { return health_.failures; }
+  // Number of recoveries since begin
+  inline uint16_t getRecoveries() { return health_.recoveries; }
+  // Highest action of the recent recovery
+  inline HealthLevels getHealthLevel() { return health_.level; }
+  // Flag about swapped probe detected by the recent recovery
+  inline bool getProbeSwapped() { return health_.swapped; }
+  // Link quality since begin, i.e., CRC checks and wrong CRCs
+  inline uint32_t getLinkChecks() { return link_.checks; }
+  inline uint32_t getLinkErrors() { return link_.errors; }
+  // Number of automatic steps down of bus clock since begin
+  inline uint8_t getClockStepDowns() { return link_.stepDowns; }
+  // Flag about calibration found for the connected probe
+  inline bool getCalibrated() { return calibration_.found; }
+  // Result code of the recent lookup of calibration
+  inline ResultCodes getCalibrationResult() { return calibration_.result; }
   // Flag about correct operating voltage
   inline bool getVddStatus()
   {
@@ -240,12 +753,80 @@ public:
       .rhumBits[isSuccess(reloadUserRegister()) ? resolution() : 0];
   }
 
+  // Resolution code (0 ~ 3) from RES1 and RES0 bits of user register
+  inline uint8_t getResolution()
+  {
+    return isSuccess(reloadUserRegister()) ? resolution() : 0;
+  }
+
+  // Conversion times in milliseconds for current resolution and values usage
+  inline uint8_t getConversionTimeTemp()
+  {
+    return getUseValuesTyp() ? getConversionTimeTempTyp()
+                             : getConversionTimeTempMax();
+  }
+  inline uint8_t getConversionTimeRhum()
+  {
+    return getUseValuesTyp() ? getConversionTimeRhumTyp()
+                             : getConversionTimeRhumMax();
+  }
+
+  // Conversion times in milliseconds for resolution code and values usage
+  inline uint8_t getConversionTimeTemp(uint8_t code, bool useValuesTyp)
+  {
+    code &= B11;
+    return useValuesTyp ? resolusion_.tempConvTimeTyp[code]
+                        : resolusion_.tempConvTimeMax[code];
+  }
+  inline uint8_t getConversionTimeRhum(uint8_t code, bool useValuesTyp)
+  {
+    code &= B11;
+    return useValuesTyp ? resolusion_.rhumConvTimeTyp[code]
+                        : resolusion_.rhumConvTimeMax[code];
+  }
+
   // Bad measurement value
   inline float getErrorRHT()
   {
     return static_cast<float>(Params::PARAM_BAD_RHT);
   }
 
+  // Recent valid measured binary words without status bits or zero
+  inline uint16_t getWordTemp() { return words_.tempValid ? words_.temp : 0; }
+  inline uint16_t getWordRhum() { return words_.rhumValid ? words_.rhum : 0; }
+
+  // Derived quantities from recent valid temperature and humidity words
+  inline float getDewPoint()
+  {
+    if (!words_.tempValid || !words_.rhumValid)
+    {
+      return getErrorRHT();
+    }
+    return static_cast<float>(dewPoint(wordTemperature(words_.temp),
+                                       wordHumidity(words_.rhum))) /
+           100.0;
+  }
+  inline float getAbsHumidity()
+  {
+    if (!words_.tempValid || !words_.rhumValid)
+    {
+      return getErrorRHT();
+    }
+    return static_cast<float>(absHumidity(wordTemperature(words_.temp),
+                                          wordHumidity(words_.rhum))) /
+           100.0;
+  }
+  inline float getHeatIndex()
+  {
+    if (!words_.tempValid || !words_.rhumValid)
+    {
+      return getErrorRHT();
+    }
+    return static_cast<float>(heatIndex(wordTemperature(words_.temp),
+                                        wordHumidity(words_.rhum))) /
+           100.0;
+  }
+
 private:
   enum Addresses
   {
@@ -277,12 +858,25 @@ private:
   {
     // Resetting delay in milliseconds
     TIMING_RESET = 15,
+    // Delay between pollings of finished conversion in milliseconds
+    TIMING_POLL = 1,
   };
   enum Resetting : uint8_t
   {
     // Reset Settings = 0000_0010 (datasheet User Register)
     RESET_REG_USER = 0x02,
   };
+  enum BeginStates : uint8_t
+  {
+    // Waiting for finishing the reset
+    BEGIN_RESET,
+    // Verifying reset value of the user register
+    BEGIN_VERIFY,
+    // Configuring the heater
+    BEGIN_CONFIGURE,
+    // Initialization finished or not started
+    BEGIN_DONE,
+  };
   enum Params : uint8_t
   {
     // Number of repeating action at wrong CRC
@@ -291,6 +885,14 @@ private:
     PARAM_BAD_RHT = 255,
     // Temperature coefficient - absolute value in millipercentage per degree
     PARAM_TEMP_COEF = 150,
+    // Attempts of reading published sample overlapping with publishing
+    PARAM_SAMPLE_ATTEMPTS = 3,
+    // Rounds of probing link at a bus clock
+    PARAM_LINK_PROBES = 4,
+    // Number of CRC checks in a window of link monitoring
+    PARAM_LINK_WINDOW = 64,
+    // Wrong CRCs within a window stepping bus clock down
+    PARAM_LINK_ERRORS = 2,
   };
   struct Status
   {
@@ -300,11 +902,104 @@ private:
     uint32_t serialSNB;
     // 2 SNC bytes of serial number
     uint16_t serialSNC;
+    // Flag about valid serial number
+    bool serialRead;
     // Flag about active hold master mode at measuring
     bool holdMasterMode;
     // Flag about using typical values from datasheet
     bool useValuesTyp;
+    // Number of conversions at wrong CRC or status bits
+    uint8_t retries;
+    // Flag about substituting failed measurement by recent valid value
+    bool staleEnabled;
+    // Flag about recent measured value being stale
+    bool stale;
+    // Flag about triggered conversion of temperature instead of humidity
+    bool pendingTemp;
   } status_;
+  // Recent valid measured binary words
+  struct Words
+  {
+    // Temperature word without status bits
+    uint16_t temp;
+    // Humidity word without status bits
+    uint16_t rhum;
+    // Flag about valid temperature word
+    bool tempValid;
+    // Flag about valid humidity word
+    bool rhumValid;
+    // Timestamps of recent valid words in milliseconds
+    uint32_t tempTime;
+    uint32_t rhumTime;
+  } words_;
+  // Reusing temperature for compensated humidity
+  struct TempReuse
+  {
+    // Maximal age of reused temperature in milliseconds
+    uint16_t window = 0;
+    // Temperature measured at every refresh-th humidity sample
+    uint8_t refresh = 0;
+    // Number of consecutive reuses of temperature
+    uint8_t reused;
+  } tempReuse_;
+  // Health monitoring
+  struct Health
+  {
+    // Consecutive failed measurements triggering recovery
+    uint8_t threshold = 0;
+    uint8_t failures;
+    uint16_t recoveries;
+    HealthLevels level;
+    bool swapped;
+  } health_;
+  // Callbacks of persistent storage of serial number
+  struct SerialStore
+  {
+    SerialLoader loader = NULL;
+    SerialSaver saver = NULL;
+  } serialStore_;
+  // Link quality monitoring
+  struct Link
+  {
+    bool monitoring;
+    uint32_t checks;
+    uint32_t errors;
+    uint8_t windowChecks;
+    uint8_t windowErrors;
+    uint8_t stepDowns;
+  } link_;
+  // Calibration table and corrections of the connected probe
+  struct CalibrationTable
+  {
+    const Calibration *table = NULL;
+    uint16_t count;
+    bool found;
+    // Flag about lookup at the next measurement
+    bool pending;
+    ResultCodes result;
+    Correction temp;
+    Correction rhum;
+  } calibration_;
+  // Non-blocking initialization
+  struct Begin
+  {
+    BeginStates state = BeginStates::BEGIN_DONE;
+    // Timestamp of the reset command in milliseconds
+    uint32_t timestamp;
+  } begin_;
+  // Published sample guarded by sequence counter, odd while publishing
+  struct Publication
+  {
+#if defined(__AVR__)
+    // Single byte access is atomic on 8-bit microcontrollers
+    volatile uint8_t sequence = 0;
+#else
+    volatile uint32_t sequence = 0;
+#endif
+    // Sequence wraps to zero, so that it does not mark the first publishing
+    volatile bool published = false;
+    Sample sample;
+  } publication_;
   // Parameters of user register
   struct UserReg
   {
@@ -359,7 +1054,6 @@ private:
       7,
     };
   } resolusion_;
-  inline bool getUseValuesTyp() { return status_.useValuesTyp; };
 
   inline uint8_t getConversionTimeTempTyp()
   {
@@ -372,11 +1066,6 @@ private:
     return resolusion_
       .tempConvTimeMax[isSuccess(reloadUserRegister()) ? resIdx : 0];
   }
-  inline uint8_t getConversionTimeTemp()
-  {
-    return getUseValuesTyp() ? getConversionTimeTempTyp()
-                             : getConversionTimeTempMax();
-  }
 
   inline uint8_t getConversionTimeRhumTyp()
   {
@@ -388,11 +1077,6 @@ private:
     return resolusion_
       .rhumConvTimeMax[isSuccess(reloadUserRegister()) ? resolution() : 0];
   }
-  inline uint8_t getConversionTimeRhum()
-  {
-    return getUseValuesTyp() ? getConversionTimeRhumTyp()
-                             : getConversionTimeRhumMax();
-  }
 
   /*
     Validate byte array by CRC
@@ -417,27 +1101,34 @@ private:
 
     RETURN: Flag about correct checksum
   */
-  inline bool checkCrc8(uint8_t *byteArray, uint8_t byteCnt = 2)
+  inline bool checkCrc8(const uint8_t *byteArray, uint8_t byteCnt = 2)
   {
-    uint8_t crc = 0;
-    for (uint8_t i = 0; i < byteCnt; i++)
-    {
-      crc ^= byteArray[i];
-      for (int8_t b = 7; b >= 0; b--)
-      {
-        if (crc & 0x80)
-        {
-          crc = (crc << 1) ^ 0x31;
-        }
-        else
-        {
-          crc = (crc << 1);
-        }
-      }
-    }
-    return crc == byteArray[byteCnt];
+    bool valid = calculateCrc8(byteArray, byteCnt) == byteArray[byteCnt];
+    monitorLink(valid);
+    return valid;
   }
 
+  /*
+    Probe and monitor link.
+
+    DESCRIPTION:
+    The method probeLink() reads all bytes of the serial number and the user
+    register and returns the number of failed transactions, wrong CRCs, and
+    user register values differing from the cached one.
+    The method monitorLink() accounts a CRC check and steps the bus clock down
+    if the number of wrong CRCs in the current window reaches its limit.
+
+    PARAMETERS:
+    valid - Flag about correct checksum.
+      - Data type: bool
+      - Default value: none
+      - Limited range: true, false
+
+    RETURN: Number of errors or none
+  */
+  uint8_t probeLink();
+  void monitorLink(bool valid);
+
   /*
     Calculate resolution code from user register byte.
 
@@ -469,6 +1160,37 @@ private:
     RETURN: Result code
   */
   ResultCodes readSerialNumber();
+  // Read and validate SNB bytes or SNA and SNC bytes of serial number
+  ResultCodes readSerialSNB();
+  ResultCodes readSerialSNAC();
+
+  /*
+    Read electronic serial number if needed.
+
+    DESCRIPTION:
+    The method reads the serial number if internal flag is reset. If the
+    persistent storage is set, the stored serial number is validated by SNB
+    bytes first and the newly read serial number is saved.
+
+    PARAMETERS: none
+
+    RETURN: Result code
+  */
+  ResultCodes reloadSerialNumber();
+
+  /*
+    Check serial number.
+
+    DESCRIPTION:
+    The method compares SNB bytes of the serial number read from the sensor
+    with cached ones, if the serial number has been read already. At mismatch
+    it invalidates the serial number and recent measured values.
+
+    PARAMETERS: none
+
+    RETURN: Result code
+  */
+  ResultCodes checkSerialNumber();
 
   /*
     Read user register.
@@ -626,6 +1348,211 @@ private:
     return getLastResult();
   }
 
+  /*
+    Initialize instance.
+
+    DESCRIPTION:
+    The method sets the bus address and default parameters of the instance and
+    resets its status flags without any communication with the sensor.
+
+    PARAMETERS:
+    holdMasterMode - Flag about blocking (holding) serial clock line during
+    measurement.
+      - Data type: boolean
+      - Default value: none
+      - Limited range: true, false
+
+    RETURN: Result code
+  */
+  inline ResultCodes initialize(bool holdMasterMode)
+  {
+    if (isError(gbj_twowire::begin()))
+    {
+      return getLastResult();
+    }
+    if (isError(setAddress(Addresses::ADDRESS)))
+    {
+      return getLastResult();
+    }
+    setUseValuesMax();
+    setHoldMasterMode(holdMasterMode);
+    setRetries(Params::PARAM_CRC_CHECKS);
+    setStaleDisabled();
+    words_.tempValid = words_.rhumValid = false;
+    // Serial number is read at the first request
+    status_.serialRead = false;
+    health_.failures = health_.recoveries = 0;
+    health_.level = HealthLevels::HEALTH_NONE;
+    health_.swapped = false;
+    tempReuse_.reused = 0;
+    calibration_.found = false;
+    calibration_.pending = true;
+    calibration_.result = ResultCodes::SUCCESS;
+    link_.checks = link_.errors = 0;
+    link_.windowChecks = link_.windowErrors = 0;
+    link_.stepDowns = 0;
+    link_.monitoring = false;
+    begin_.state = BeginStates::BEGIN_DONE;
+    return getLastResult();
+  }
+
+  /*
+    Read measured binary word.
+
+    DESCRIPTION:
+    The method triggers a conversion of temperature or relative humidity and
+    reads its binary word with status bits and CRC validation.
+    - In no hold master mode the conversion is triggered once and after the
+    conversion time the result is polled by read only transactions without
+    repeating the command, at most for maximal conversion time.
+    - At wrong CRC or status bits the conversion is repeated up to the number
+    of retries set by setRetries().
+    - If stale values are enabled and the measurement fails, the recent valid
+    word is provided instead, the stale flag is set, and the result code is
+    success.
+
+    PARAMETERS:
+    isTemperature - Flag about measuring temperature instead of humidity.
+      - Data type: bool
+      - Default value: none
+      - Limited range: true, false
+
+    wordMeasure - Referenced variable for placing the binary word without
+    status bits.
+      - Data type: integer
+      - Default value: none
+      - Limited range: 0x0000 ~ 0xFFFC
+
+    RETURN: Result code
+  */
+  ResultCodes readMeasurement(bool isTemperature, uint16_t &wordMeasure);
+
+  /*
+    Measure and publish sample.
+
+    DESCRIPTION:
+    The method readSample() measures temperature, or reuses the recent one, and
+    compensated relative humidity. The method publishSample() stores them with
+    the timestamp and the stale flag to the publication slot for readers of
+    the method getSample().
+
+    PARAMETERS:
+    temperature - Referenced variable for placing the temperature in
+    centigrades.
+      - Data type: float
+      - Default value: none
+      - Limited range: -40.0 ~ 125.0
+
+    humidity - Compensated relative humidity in per-cents.
+      - Data type: float
+      - Default value: none
+      - Limited range: 0.0 ~ 100.0
+
+    stale - Flag about any quantity substituted by recent valid value.
+      - Data type: bool
+      - Default value: none
+      - Limited range: true, false
+
+    RETURN: Compensated relative humidity in per-cents or none
+  */
+  inline float readSample(float &temperature, bool &stale)
+  {
+    stale = false;
+    // Reuse recent temperature if it is fresh enough
+    if (isTempReusable())
+    {
+      temperature = calculateTemperature(words_.temp);
+      tempReuse_.reused++;
+    }
+    else
+    {
+      temperature = measureTemperature();
+      if (isError())
+      {
+        return getErrorRHT();
+      }
+      stale = getStale();
+      tempReuse_.reused = 0;
+    }
+    float humidity = readHumidity();
+    if (isError())
+    {
+      return humidity;
+    }
+    // Humidity measurement reset the flag of substituted temperature
+    stale = stale || getStale();
+    status_.stale = stale;
+    return compensateHumidity(humidity, temperature);
+  }
+
+  void publishSample(float temperature, float humidity, bool stale);
+
+  /*
+    Split phases of measurement.
+
+    DESCRIPTION:
+    The method triggerMeasurement() sends measurement command in no hold master
+    mode. The method fetchWord() reads the result of triggered conversion by a
+    read only transaction. The method storeWord() validates status bits and CRC
+    of read data and stores the binary word as recent valid one.
+
+    PARAMETERS:
+    isTemperature - Flag about measuring temperature instead of humidity.
+      - Data type: bool
+      - Default value: none
+      - Limited range: true, false
+
+    data - Pointer to 3 read bytes.
+      - Data type: pointer
+      - Default value: none
+      - Limited range: none
+
+    wordMeasure - Referenced variable for placing the binary word without
+    status bits.
+      - Data type: integer
+      - Default value: none
+      - Limited range: 0x0000 ~ 0xFFFC
+
+    RETURN: Result code or flag about valid data
+  */
+  ResultCodes triggerMeasurement(bool isTemperature);
+  ResultCodes fetchWord(uint16_t &wordMeasure);
+  bool storeWord(bool isTemperature,
+                 const uint8_t *data,
+                 uint16_t &wordMeasure);
+
+  /*
+    Look up and apply calibration.
+
+    DESCRIPTION:
+    The method lookupCalibration() reads the serial number of the sensor and
+    searches the calibration table for it. It stores its result code for the
+    method getCalibrationResult(). The method correctWord() applies
+    the correction to a binary word in fixed point arithmetic.
+
+    PARAMETERS:
+    wordMeasure - Binary word without status bits.
+      - Data type: integer
+      - Default value: none
+      - Limited range: 0x0000 ~ 0xFFFC
+
+    correction - Correction of the measured quantity.
+      - Data type: Correction
+      - Default value: none
+      - Limited range: none
+
+    RETURN: Result code or corrected binary word without status bits
+  */
+  ResultCodes lookupCalibration();
+  inline uint16_t correctWord(uint16_t wordMeasure,
+                              const Correction &correction)
+  {
+    int32_t word = (static_cast<uint32_t>(wordMeasure) * correction.gain) >> 14;
+    word += correction.offset;
+    word = constrain(word, 0, 0xFFFC);
+    return word & 0xFFFC;
+  }
+
   /*
     Calculate temperature.
 
@@ -675,6 +1602,100 @@ private:
     return humidity;
   }
 
+  /*
+    Convert measured binary word to centi-units.
+
+    DESCRIPTION:
+    The particular method calculates temperature in centi-centigrades or
+    relative humidity in centi-percents from 16-bit word by integer arithmetic
+    with the same formulas as the floating point counterparts.
+
+    PARAMETERS:
+    wordMeasure - Measured binary word.
+      - Data type: integer
+      - Default value: none
+      - Limited range: 0x0000 ~ 0xFFFF
+
+    RETURN: Temperature in 0.01 centigrade or relative humidity in 0.01 %
+  */
+  inline int16_t wordTemperature(uint16_t wordMeasure)
+  {
+    return static_cast<int16_t>((17572L * wordMeasure) >> 16) - 4685;
+  }
+  inline uint16_t wordHumidity(uint16_t wordMeasure)
+  {
+    int16_t humidity =
+      static_cast<int16_t>((12500L * wordMeasure) >> 16) - 600;
+    return constrain(humidity, 0, 10000);
+  }
+
+  /*
+    Convert floating point value to centi-units.
+
+    DESCRIPTION:
+    The particular method converts temperature in centigrades or relative
+    humidity in per-cents to the integer centi-units limited to the sensor's
+    range.
+
+    PARAMETERS:
+    temperature, humidity - Value to be converted.
+      - Data type: float
+      - Default value: none
+      - Limited range: none
+
+    RETURN: Temperature in 0.01 centigrade or relative humidity in 0.01 %
+  */
+  inline int16_t centiTemperature(float temperature)
+  {
+    return static_cast<int16_t>(constrain(temperature, -40.0, 125.0) * 100.0);
+  }
+  inline uint16_t centiHumidity(float humidity)
+  {
+    return static_cast<uint16_t>(sanitizeHumidity(humidity) * 100.0);
+  }
+
+  /*
+    Calculate derived quantity in centi-units.
+
+    DESCRIPTION:
+    The particular method calculates dew point, absolute humidity, or heat
+    index by integer arithmetic from lookup tables.
+
+    PARAMETERS:
+    temperature - Temperature in 0.01 centigrade.
+      - Data type: integer
+      - Default value: none
+      - Limited range: -4000 ~ 12500
+
+    humidity - Relative humidity in 0.01 %.
+      - Data type: non-negative integer
+      - Default value: none
+      - Limited range: 0 ~ 10000
+
+    RETURN: Dew point or heat index in 0.01 centigrade, absolute humidity in
+    0.01 g/m3
+  */
+  int16_t dewPoint(int16_t temperature, uint16_t humidity);
+  int32_t absHumidity(int16_t temperature, uint16_t humidity);
+  int16_t heatIndex(int16_t temperature, uint16_t humidity);
+
+  // Flag about recent valid temperature suitable for reuse
+  inline bool isTempReusable()
+  {
+    if (!words_.tempValid ||
+        (tempReuse_.window == 0 && tempReuse_.refresh == 0))
+    {
+      return false;
+    }
+    if (tempReuse_.window &&
+        millis() - words_.tempTime >= tempReuse_.window)
+    {
+      return false;
+    }
+    return tempReuse_.refresh == 0 ||
+           tempReuse_.reused + 1 < tempReuse_.refresh;
+  }
+
   /*
     Sanitized relative humidity.
 
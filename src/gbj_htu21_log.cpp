@@ -0,0 +1,274 @@
+#include "gbj_htu21_log.h"
+
+gbj_htu21_log::ResultCodes gbj_htu21_log::begin(uint16_t pages,
+                                                uint16_t pageSize,
+                                                uint32_t period)
+{
+  status_.pages = pages;
+  status_.pageSize = pageSize;
+  status_.period = period;
+  status_.open = false;
+  status_.records = status_.bytes = 0;
+  // Start at the first page without any valid one
+  status_.page = pages - 1;
+  status_.sequence = 0;
+  if (pages < 2 || pageSize < Format::FORMAT_HEADER + Format::FORMAT_RECORD)
+  {
+    return sensor_.setLastResult(gbj_htu21::ResultCodes::ERROR_BUFFER);
+  }
+  // Find the newest page by its sequence number
+  uint8_t header[Format::FORMAT_HEADER];
+  for (uint16_t page = 0; page < pages; page++)
+  {
+    if (!reader_(pageAddress(page), header, sizeof(header)))
+    {
+      return sensor_.setLastResult(gbj_htu21::ResultCodes::ERROR_BUFFER);
+    }
+    if (header[0] != Format::FORMAT_MAGIC)
+    {
+      continue;
+    }
+    uint32_t sequence = 0;
+    for (uint8_t i = 1; i <= 4; i++)
+    {
+      sequence = (sequence << 8) | header[i];
+    }
+    if (!status_.open ||
+        static_cast<int32_t>(sequence - status_.sequence) > 0)
+    {
+      status_.open = true;
+      status_.page = page;
+      status_.sequence = sequence;
+      status_.code = header[5] & B11;
+      status_.timestamp = 0;
+      for (uint8_t i = 10; i <= 13; i++)
+      {
+        status_.timestamp = (status_.timestamp << 8) | header[i];
+      }
+      status_.temp = (header[14] << 8) | header[15];
+      status_.rhum = (header[16] << 8) | header[17];
+    }
+  }
+  if (!status_.open)
+  {
+    return sensor_.setLastResult(gbj_htu21::ResultCodes::SUCCESS);
+  }
+  // Replay records of the newest page to the end of its data
+  uint8_t buffer[Format::FORMAT_RECORD];
+  status_.offset = Format::FORMAT_HEADER;
+  while (status_.offset < status_.pageSize)
+  {
+    uint16_t len = status_.pageSize - status_.offset;
+    len = len < sizeof(buffer) ? len : sizeof(buffer);
+    if (!reader_(pageAddress(status_.page) + status_.offset, buffer, len))
+    {
+      return sensor_.setLastResult(gbj_htu21::ResultCodes::ERROR_BUFFER);
+    }
+    if (buffer[0] == Format::FORMAT_ERASED)
+    {
+      break;
+    }
+    uint8_t recordLen = decodeRecord(buffer, len);
+    if (recordLen == 0)
+    {
+      // Incomplete record, continue on the next page
+      status_.open = false;
+      break;
+    }
+    status_.offset += recordLen;
+  }
+  return sensor_.setLastResult(gbj_htu21::ResultCodes::SUCCESS);
+}
+
+gbj_htu21_log::ResultCodes gbj_htu21_log::append(uint32_t timestamp)
+{
+  uint16_t temp = sensor_.getWordTemp();
+  uint16_t rhum = sensor_.getWordRhum();
+  if (temp == 0 || rhum == 0)
+  {
+    return sensor_.setLastResult(gbj_htu21::ResultCodes::ERROR_MEASURE);
+  }
+  uint8_t code = sensor_.getResolution();
+  if (sensor_.isError())
+  {
+    return sensor_.getLastResult();
+  }
+  temp >>= shiftTemp(code);
+  rhum >>= shiftRhum(code);
+  if (!status_.open || code != status_.code ||
+      static_cast<int32_t>(timestamp - status_.timestamp) < 0)
+  {
+    return openPage(timestamp, code, temp, rhum);
+  }
+  uint32_t count = periods(timestamp - status_.timestamp);
+  uint8_t record[Format::FORMAT_RECORD];
+  uint8_t recordLen = encodeRecord(record, count, temp, rhum);
+  if (status_.offset + recordLen > status_.pageSize)
+  {
+    return openPage(timestamp, code, temp, rhum);
+  }
+  if (!writer_(pageAddress(status_.page) + status_.offset, record, recordLen))
+  {
+    status_.open = false;
+    return sensor_.setLastResult(gbj_htu21::ResultCodes::ERROR_BUFFER);
+  }
+  // Timestamps are rebuilt from whole periods
+  status_.timestamp += status_.period ? count * status_.period : count;
+  status_.temp = temp;
+  status_.rhum = rhum;
+  status_.offset += recordLen;
+  status_.records++;
+  status_.bytes += recordLen;
+  return sensor_.setLastResult(gbj_htu21::ResultCodes::SUCCESS);
+}
+
+gbj_htu21_log::ResultCodes gbj_htu21_log::openPage(uint32_t timestamp,
+                                                   uint8_t code,
+                                                   uint16_t temp,
+                                                   uint16_t rhum)
+{
+  // Next page in the ring for even wear
+  status_.open = false;
+  status_.page = (status_.page + 1) % status_.pages;
+  status_.sequence++;
+  if (!eraser_(pageAddress(status_.page)))
+  {
+    return sensor_.setLastResult(gbj_htu21::ResultCodes::ERROR_BUFFER);
+  }
+  uint8_t header[Format::FORMAT_HEADER];
+  header[0] = Format::FORMAT_MAGIC;
+  for (uint8_t i = 0; i < 4; i++)
+  {
+    header[1 + i] = status_.sequence >> (24 - 8 * i);
+    header[6 + i] = status_.period >> (24 - 8 * i);
+    header[10 + i] = timestamp >> (24 - 8 * i);
+  }
+  header[5] = code;
+  header[14] = highByte(temp);
+  header[15] = lowByte(temp);
+  header[16] = highByte(rhum);
+  header[17] = lowByte(rhum);
+  // Magic byte last, so that an interrupted header does not validate a page
+  if (!writer_(pageAddress(status_.page) + 1, &header[1], sizeof(header) - 1) ||
+      !writer_(pageAddress(status_.page), header, 1))
+  {
+    return sensor_.setLastResult(gbj_htu21::ResultCodes::ERROR_BUFFER);
+  }
+  status_.open = true;
+  status_.offset = sizeof(header);
+  status_.code = code;
+  status_.timestamp = timestamp;
+  status_.temp = temp;
+  status_.rhum = rhum;
+  status_.records++;
+  status_.bytes += sizeof(header);
+  return sensor_.setLastResult(gbj_htu21::ResultCodes::SUCCESS);
+}
+
+uint8_t gbj_htu21_log::encodeRecord(uint8_t *buffer,
+                                    uint32_t periods,
+                                    uint16_t temp,
+                                    uint16_t rhum)
+{
+  bool timeFlag = (periods != 1);
+  uint32_t value = (zigzag(static_cast<int32_t>(temp) - status_.temp) << 1) |
+                   (timeFlag ? 1 : 0);
+  // First byte with 6 data bits and continuation flag
+  uint8_t len = 0;
+  buffer[len++] = (value & 0x3F) | (value > 0x3F ? 0x40 : 0);
+  if (value > 0x3F)
+  {
+    len += putVarint(&buffer[len], value >> 6);
+  }
+  if (timeFlag)
+  {
+    len += putVarint(&buffer[len], periods);
+  }
+  len +=
+    putVarint(&buffer[len], zigzag(static_cast<int32_t>(rhum) - status_.rhum));
+  return len;
+}
+
+uint8_t gbj_htu21_log::decodeRecord(const uint8_t *buffer, uint8_t bufferLen)
+{
+  if (bufferLen == 0 || (buffer[0] & 0x80))
+  {
+    return 0;
+  }
+  uint8_t len = 1;
+  uint32_t value = buffer[0] & 0x3F;
+  if (buffer[0] & 0x40)
+  {
+    uint32_t high;
+    uint8_t varLen = getVarint(&buffer[len], bufferLen - len, high);
+    if (varLen == 0)
+    {
+      return 0;
+    }
+    value |= high << 6;
+    len += varLen;
+  }
+  uint32_t count = 1;
+  if (value & 1)
+  {
+    uint8_t varLen = getVarint(&buffer[len], bufferLen - len, count);
+    if (varLen == 0)
+    {
+      return 0;
+    }
+    len += varLen;
+  }
+  uint32_t rhum;
+  uint8_t varLen = getVarint(&buffer[len], bufferLen - len, rhum);
+  if (varLen == 0)
+  {
+    return 0;
+  }
+  len += varLen;
+  status_.temp += unzigzag(value >> 1);
+  status_.rhum += unzigzag(rhum);
+  status_.timestamp += status_.period ? count * status_.period : count;
+  return len;
+}
+
+uint8_t gbj_htu21_log::putVarint(uint8_t *buffer, uint32_t value)
+{
+  uint8_t len = 0;
+  while (value > 0x7F)
+  {
+    buffer[len++] = (value & 0x7F) | 0x80;
+    value >>= 7;
+  }
+  buffer[len++] = value;
+  return len;
+}
+
+uint8_t gbj_htu21_log::getVarint(const uint8_t *buffer,
+                                 uint8_t bufferLen,
+                                 uint32_t &value)
+{
+  value = 0;
+  for (uint8_t i = 0; i < bufferLen && i < 5; i++)
+  {
+    value |= static_cast<uint32_t>(buffer[i] & 0x7F) << (7 * i);
+    if (!(buffer[i] & 0x80))
+    {
+      return i + 1;
+    }
+  }
+  return 0;
+}
+
+uint8_t gbj_htu21_log::shiftTemp(uint8_t code)
+{
+  // Temperature resolutions 14, 12, 13, 11 bits
+  const uint8_t shifts[] = { 2, 4, 3, 5 };
+  return shifts[code & B11];
+}
+
+uint8_t gbj_htu21_log::shiftRhum(uint8_t code)
+{
+  // Humidity resolutions 12, 8, 10, 11 bits
+  const uint8_t shifts[] = { 4, 8, 6, 5 };
+  return shifts[code & B11];
+}
@@ -0,0 +1,224 @@
+/*
+  NAME:
+  gbjHTU21Log
+
+  DESCRIPTION:
+  Compressed log of samples measured with sensors HTU21D(F), SHT21, SHT20,
+  HDC1080 driven by the library gbjHTU21 in flash memory or EEPROM.
+  - Binary words of temperature and relative humidity are reduced to their
+  resolution and delta encoded against the previous sample by variable length
+  integers, so that a sample in a stable environment takes 2 bytes instead of
+  8 bytes of two floats.
+  - Samples are appended to pages of the storage, which are written only once
+  after erasing, and pages are rotated in a ring, so that all of them are
+  erased evenly.
+  - Each page starts with a header with absolute values, so that it can be
+  decoded independently. The host program in the folder
+  extras/gbj_htu21_logdecode rebuilds the time series from a storage image.
+
+  LICENSE:
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the MIT License (MIT).
+
+  CREDENTIALS:
+  Author: Libor Gabaj
+  GitHub: https://github.com/mrkaleArduinoLib/gbj_htu21.git
+*/
+#ifndef GBJ_HTU21_LOG_H
+#define GBJ_HTU21_LOG_H
+
+#include "gbj_htu21.h"
+
+class gbj_htu21_log
+{
+public:
+  typedef gbj_htu21::ResultCodes ResultCodes;
+  // Storage access functions returning flag about success
+  typedef bool (*StorageReader)(uint32_t address, uint8_t *data, uint16_t len);
+  typedef bool (*StorageWriter)(uint32_t address,
+                                const uint8_t *data,
+                                uint16_t len);
+  typedef bool (*StorageEraser)(uint32_t address);
+
+  enum Format : uint8_t
+  {
+    // Marker of a valid page header
+    FORMAT_MAGIC = 0x48,
+    // Size of the page header in bytes (magic, page sequence, resolution code,
+    // period, timestamp, temperature, humidity)
+    FORMAT_HEADER = 18,
+    // Maximal size of a record in bytes
+    FORMAT_RECORD = 11,
+    // Byte of erased storage
+    FORMAT_ERASED = 0xFF,
+  };
+
+  /*
+    Constructor.
+
+    DESCRIPTION:
+    The constructor stores the sensor and functions accessing the storage.
+    - The eraser should fill the whole page with erased bytes 0xFF, even on
+    EEPROM, because the end of records on a page is detected by them.
+    Otherwise begin() replays old records past the real end of the page.
+    - The page header is written with its magic byte last in a separate
+    writing, so that a header interrupted by a power loss is not valid.
+
+    PARAMETERS:
+    sensor - Sensor with measured binary words.
+      - Data type: gbj_htu21
+      - Default value: none
+      - Limited range: none
+
+    reader, writer, eraser - Pointers to functions accessing the storage.
+      - Data type: pointer
+      - Default value: none
+      - Limited range: none
+  */
+  gbj_htu21_log(gbj_htu21 &sensor,
+                StorageReader reader,
+                StorageWriter writer,
+                StorageEraser eraser)
+    : sensor_(sensor)
+    , reader_(reader)
+    , writer_(writer)
+    , eraser_(eraser){};
+
+  /*
+    Initialize log.
+
+    DESCRIPTION:
+    The method stores the geometry of the storage and the sampling period and
+    finds the newest page and the end of its records, so that appending
+    continues after a reboot.
+    - A page with an incomplete record, e.g., after power loss during writing,
+    is closed and appending continues on the next page.
+
+    PARAMETERS:
+    pages - Number of pages of the storage.
+      - Data type: non-negative integer
+      - Default value: none
+      - Limited range: 2 ~ 65535
+
+    pageSize - Size of a page in bytes, i.e., the erase unit of a flash memory.
+      - Data type: non-negative integer
+      - Default value: none
+      - Limited range: 29 ~ 65535
+
+    period - Nominal sampling period in units of timestamps. At zero every
+    sample stores its time difference.
+      - Data type: non-negative integer
+      - Default value: none
+      - Limited range: 0 ~ 2^32 - 1
+
+    RETURN: Result code, ERROR_BUFFER at failed storage access
+  */
+  ResultCodes begin(uint16_t pages, uint16_t pageSize, uint32_t period);
+
+  /*
+    Append sample.
+
+    DESCRIPTION:
+    The method appends recent valid binary words of temperature and relative
+    humidity of the sensor to the log.
+    - A new page is started, when the recent one is full, the resolution has
+    changed, or the timestamp is older than the previous one, e.g., after
+    a reboot without real time clock.
+    - Timestamps are stored in multiples of the period, so that they are
+    rebuilt within half of the period.
+
+    PARAMETERS:
+    timestamp - Time of the sample in any units, e.g., milliseconds or seconds.
+      - Data type: non-negative integer
+      - Default value: none
+      - Limited range: 0 ~ 2^32 - 1
+
+    RETURN: Result code, ERROR_MEASURE without valid measured values,
+    ERROR_BUFFER at failed storage access
+  */
+  ResultCodes append(uint32_t timestamp);
+
+  // Getters
+  inline uint16_t getPage() { return status_.page; }
+  inline uint16_t getOffset() { return status_.offset; }
+  inline uint32_t getPageSequence() { return status_.sequence; }
+  inline uint32_t getRecords() { return status_.records; }
+  inline uint32_t getBytes() { return status_.bytes; }
+
+private:
+  struct Status
+  {
+    uint16_t pages;
+    uint16_t pageSize;
+    uint32_t period;
+    // Current page, its sequence number, and offset of the next record
+    uint16_t page;
+    uint32_t sequence;
+    uint16_t offset;
+    // Flag about a page open for appending
+    bool open;
+    // Recent sample reduced to resolution and its rebuilt timestamp
+    uint8_t code;
+    uint32_t timestamp;
+    uint16_t temp;
+    uint16_t rhum;
+    // Appended records and written bytes since begin
+    uint32_t records;
+    uint32_t bytes;
+  } status_;
+  gbj_htu21 &sensor_;
+  StorageReader reader_;
+  StorageWriter writer_;
+  StorageEraser eraser_;
+
+  inline uint32_t pageAddress(uint16_t page)
+  {
+    return static_cast<uint32_t>(page) * status_.pageSize;
+  }
+  // Number of periods between timestamps rounded, or the difference itself
+  inline uint32_t periods(uint32_t difference)
+  {
+    return status_.period ? (difference + status_.period / 2) / status_.period
+                          : difference;
+  }
+  inline uint32_t zigzag(int32_t value)
+  {
+    return (static_cast<uint32_t>(value) << 1) ^ (value < 0 ? 0xFFFFFFFF : 0);
+  }
+  inline int32_t unzigzag(uint32_t value)
+  {
+    return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+  }
+  uint8_t putVarint(uint8_t *buffer, uint32_t value);
+  // Return number of bytes of the decoded value or zero at incomplete one
+  uint8_t getVarint(const uint8_t *buffer, uint8_t bufferLen, uint32_t &value);
+
+  /*
+    Encode and decode record.
+
+    DESCRIPTION:
+    A record consists of the first varint with 6 data bits in the first byte,
+    which contains zigzag encoded difference of temperature shifted left by
+    one bit with the flag about time difference other than one period. Then
+    the varint with the number of periods follows, if the flag is set, and
+    finally the varint with zigzag encoded difference of humidity.
+    - The first byte of a record never has the most significant bit set, so
+    that it cannot be mistaken for erased storage.
+
+    RETURN: Number of bytes of the record or zero at incomplete one
+  */
+  uint8_t encodeRecord(uint8_t *buffer,
+                       uint32_t periods,
+                       uint16_t temp,
+                       uint16_t rhum);
+  uint8_t decodeRecord(const uint8_t *buffer, uint8_t bufferLen);
+  ResultCodes openPage(uint32_t timestamp,
+                       uint8_t code,
+                       uint16_t temp,
+                       uint16_t rhum);
+  // Shifts of binary words reducing them to resolution
+  uint8_t shiftTemp(uint8_t code);
+  uint8_t shiftRhum(uint8_t code);
+};
+
+#endif
@@ -0,0 +1,148 @@
+#include "gbj_htu21_sampler.h"
+
+gbj_htu21_sampler::ResultCodes gbj_htu21_sampler::begin(uint32_t period)
+{
+  status_.period = period;
+  status_.deadline = millis() + leadTime();
+  status_.timestamp = 0;
+  status_.samples = status_.failures = status_.missed = 0;
+  status_.jitterSum = 0;
+  status_.jitterMin = status_.jitterMax = 0;
+  status_.state = STATE_IDLE;
+  status_.temperature = status_.humidity = sensor_.getErrorRHT();
+  return sensor_.setLastResult(period < leadTime()
+                                 ? gbj_htu21::ResultCodes::ERROR_MEASURE
+                                 : gbj_htu21::ResultCodes::SUCCESS);
+}
+
+bool gbj_htu21_sampler::run()
+{
+  switch (status_.state)
+  {
+    case STATE_IDLE:
+    {
+      int32_t lag =
+        static_cast<int32_t>(millis() - (status_.deadline - leadTime()));
+      if (lag < 0)
+      {
+        return false;
+      }
+      // Skip deadlines, which cannot be met anymore, and wait for the next one
+      if (status_.period > 0 && lag > Params::PARAM_LAG_TOLERANCE)
+      {
+        uint32_t skipped = (lag + status_.period - 1) / status_.period;
+        status_.missed += skipped;
+        status_.deadline += skipped * status_.period;
+        return false;
+      }
+      if (sensor_.isError(trigger(true)))
+      {
+        finish(false);
+        return false;
+      }
+      status_.state = STATE_TEMP;
+      return false;
+    }
+
+    case STATE_TEMP:
+      if (!fetch(true, status_.temperature))
+      {
+        return false;
+      }
+      if (sensor_.isError() || sensor_.isError(trigger(false)))
+      {
+        finish(false);
+        return false;
+      }
+      status_.state = STATE_RHUM;
+      return false;
+
+    case STATE_RHUM:
+      if (!fetch(false, status_.humidity))
+      {
+        return false;
+      }
+      if (sensor_.isError())
+      {
+        finish(false);
+        return false;
+      }
+      status_.humidity =
+        sensor_.compensateHumidity(status_.humidity, status_.temperature);
+      finish(true);
+      return true;
+  }
+  return false;
+}
+
+gbj_htu21_sampler::ResultCodes gbj_htu21_sampler::trigger(bool isTemperature)
+{
+  status_.tries = 1;
+  status_.timeTrigger = millis();
+  return isTemperature ? sensor_.triggerTemperature()
+                       : sensor_.triggerHumidity();
+}
+
+bool gbj_htu21_sampler::fetch(bool isTemperature, float &value)
+{
+  uint32_t elapsed = millis() - status_.timeTrigger;
+  if (elapsed < (isTemperature ? sensor_.getConversionTimeTemp()
+                               : sensor_.getConversionTimeRhum()))
+  {
+    return false;
+  }
+  switch (sensor_.fetchMeasurement(value))
+  {
+    case gbj_htu21::ResultCodes::ERROR_RCV_DATA:
+    {
+      // Conversion not finished yet within maximal conversion time
+      uint8_t code = sensor_.getResolution();
+      return elapsed > (isTemperature
+                          ? sensor_.getConversionTimeTemp(code, false)
+                          : sensor_.getConversionTimeRhum(code, false));
+    }
+
+    case gbj_htu21::ResultCodes::ERROR_MEASURE:
+      // Wrong CRC or status bits, trigger again
+      if (status_.tries < sensor_.getRetries())
+      {
+        uint8_t tries = status_.tries;
+        if (sensor_.isSuccess(trigger(isTemperature)))
+        {
+          status_.tries = tries + 1;
+          return false;
+        }
+      }
+      return true;
+
+    default:
+      return true;
+  }
+}
+
+void gbj_htu21_sampler::finish(bool success)
+{
+  if (success)
+  {
+    int32_t jitter = static_cast<int32_t>(millis() - status_.deadline);
+    jitter = constrain(jitter, INT16_MIN, INT16_MAX);
+    if (status_.samples == 0 || jitter < status_.jitterMin)
+    {
+      status_.jitterMin = jitter;
+    }
+    if (status_.samples == 0 || jitter > status_.jitterMax)
+    {
+      status_.jitterMax = jitter;
+    }
+    status_.jitterSum += jitter;
+    status_.samples++;
+  }
+  else
+  {
+    status_.failures++;
+    status_.temperature = status_.humidity = sensor_.getErrorRHT();
+  }
+  status_.timestamp = status_.deadline;
+  status_.deadline += status_.period;
+  status_.state = STATE_IDLE;
+}
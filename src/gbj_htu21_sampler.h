@@ -0,0 +1,142 @@
+/*
+  NAME:
+  gbjHTU21Sampler
+
+  DESCRIPTION:
+  Drift-free periodic sampler of temperature and relative humidity with sensors
+  HTU21D(F), SHT21, SHT20, HDC1080 driven by the library gbjHTU21.
+  - Samples are scheduled against absolute deadlines, so that the sampling
+  period does not drift by conversion times and repeated measurements.
+  - Conversions are triggered ahead of each deadline by the conversion times
+  of the current resolution, so that data is ready at the deadline.
+  - The sampler does not block. It measures jitter of finished samples against
+  their deadlines and counts missed deadlines.
+
+  LICENSE:
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the MIT License (MIT).
+
+  CREDENTIALS:
+  Author: Libor Gabaj
+  GitHub: https://github.com/mrkaleArduinoLib/gbj_htu21.git
+*/
+#ifndef GBJ_HTU21_SAMPLER_H
+#define GBJ_HTU21_SAMPLER_H
+
+#include "gbj_htu21.h"
+
+class gbj_htu21_sampler
+{
+public:
+  typedef gbj_htu21::ResultCodes ResultCodes;
+
+  gbj_htu21_sampler(gbj_htu21 &sensor)
+    : sensor_(sensor){};
+
+  /*
+    Initialize sampler.
+
+    DESCRIPTION:
+    The method stores the sampling period, resets statistics, and schedules
+    the first deadline as soon as conversions can be finished.
+
+    PARAMETERS:
+    period - Sampling period in milliseconds.
+      - Data type: non-negative integer
+      - Default value: none
+      - Limited range: 0 ~ 2^31 - 1
+
+    RETURN: Result code, ERROR_MEASURE if the period is shorter than
+    the conversion times of both quantities
+  */
+  ResultCodes begin(uint32_t period);
+
+  /*
+    Run sampler.
+
+    DESCRIPTION:
+    The method triggers conversions ahead of the deadline, fetches finished
+    conversions, and completes the sample with temperature and compensated
+    relative humidity.
+    - The method never waits and should be called in the loop of a sketch as
+    often as possible, at least once per millisecond around deadlines.
+    - If a conversion cannot be triggered in time for the deadline anymore,
+    i.e., later than the tolerance of 1 ms, the deadline is missed and the
+    conversion is triggered for the next deadline on the grid of periods.
+    - Failed samples are counted and do not shift next deadlines.
+
+    PARAMETERS: none
+
+    RETURN: Flag about new valid sample
+  */
+  bool run();
+
+  // Getters
+  inline uint32_t getPeriod() { return status_.period; }
+  // Deadline of the recent sample in milliseconds
+  inline uint32_t getTimestamp() { return status_.timestamp; }
+  inline uint32_t getSamples() { return status_.samples; }
+  inline uint32_t getFailures() { return status_.failures; }
+  inline uint32_t getMissed() { return status_.missed; }
+  // Jitter statistics of finished samples against deadlines in milliseconds
+  inline int16_t getJitterMin() { return status_.jitterMin; }
+  inline int16_t getJitterMax() { return status_.jitterMax; }
+  inline int16_t getJitterAvg()
+  {
+    return status_.samples
+             ? status_.jitterSum / static_cast<int32_t>(status_.samples)
+             : 0;
+  }
+  inline float getTemperature() { return status_.temperature; }
+  inline float getHumidity() { return status_.humidity; }
+
+private:
+  enum Params : uint8_t
+  {
+    // Lateness of triggering in milliseconds still sampled for the deadline
+    PARAM_LAG_TOLERANCE = 1,
+  };
+  enum States : uint8_t
+  {
+    // Waiting for triggering conversion of temperature
+    STATE_IDLE,
+    // Converting temperature
+    STATE_TEMP,
+    // Converting relative humidity
+    STATE_RHUM,
+  };
+  struct Status
+  {
+    uint32_t period;
+    // Absolute time of the next sample in milliseconds
+    uint32_t deadline;
+    uint32_t timestamp;
+    // Timestamp of recent conversion trigger in milliseconds
+    uint32_t timeTrigger;
+    uint32_t samples;
+    uint32_t failures;
+    uint32_t missed;
+    int32_t jitterSum;
+    int16_t jitterMin;
+    int16_t jitterMax;
+    // Triggers of the current conversion
+    uint8_t tries;
+    States state;
+    float temperature;
+    float humidity;
+  } status_;
+  gbj_htu21 &sensor_;
+
+  // Time in milliseconds needed for conversions of both quantities
+  inline uint32_t leadTime()
+  {
+    return sensor_.getConversionTimeTemp() + sensor_.getConversionTimeRhum();
+  }
+  ResultCodes trigger(bool isTemperature);
+  // Fetch conversion, return true if it is finished successfully or not
+  bool fetch(bool isTemperature, float &value);
+  // Finish current sample and schedule the next deadline
+  void finish(bool success);
+};
+
+#endif
@@ -0,0 +1,91 @@
+#include "gbj_htu21_scheduler.h"
+
+gbj_htu21_scheduler::ResultCodes gbj_htu21_scheduler::begin(uint32_t period,
+                                                            uint32_t budget)
+{
+  // Resolution codes ordered from the finest to the coarsest resolution
+  const uint8_t codes[] = { 0, 2, 1, 3 };
+  status_.period = period;
+  status_.budget = budget;
+  status_.chargeTotal = 0;
+  status_.samples = 0;
+  status_.timeActive = 0;
+  status_.timeBegin = millis();
+  status_.temperature = status_.humidity = sensor_.getErrorRHT();
+  uint8_t code = codes[sizeof(codes) / sizeof(codes[0]) - 1];
+  bool holdMasterMode = sensor_.getHoldMasterMode();
+  bool useValuesTyp = sensor_.getUseValuesTyp();
+  bool fit = false;
+  for (uint8_t i = 0; i < sizeof(codes) / sizeof(codes[0]) && !fit; i++)
+  {
+    if (estimateCharge(codes[i], holdMasterMode, useValuesTyp) <= budget &&
+        conversionTime(codes[i]) <= period)
+    {
+      code = codes[i];
+      fit = true;
+    }
+  }
+  if (sensor_.isError(sensor_.setResolution(code)))
+  {
+    return sensor_.getLastResult();
+  }
+  status_.chargeSample = estimateCharge(code, holdMasterMode, useValuesTyp);
+  return sensor_.setLastResult(fit ? gbj_htu21::ResultCodes::SUCCESS
+                                   : gbj_htu21::ResultCodes::ERROR_MEASURE);
+}
+
+bool gbj_htu21_scheduler::run()
+{
+  if (status_.samples > 0 && millis() - status_.timeSample < status_.period)
+  {
+    return false;
+  }
+  status_.timeSample = millis();
+  status_.humidity = sensor_.measureHumidity(status_.temperature);
+  status_.timeActive += millis() - status_.timeSample;
+  status_.chargeTotal += status_.chargeSample;
+  status_.samples++;
+  return sensor_.isSuccess();
+}
+
+uint32_t gbj_htu21_scheduler::estimateCharge(uint8_t code,
+                                             bool holdMasterMode,
+                                             bool useValuesTyp)
+{
+  // Temperature and humidity conversion
+  uint16_t bytes = 2 * Params::PARAM_BYTES_HOLD;
+  if (!holdMasterMode && useValuesTyp)
+  {
+    // Pollings from typical up to maximal conversion times
+    uint16_t polls = conversionTime(code) -
+                     sensor_.getConversionTimeTemp(code, true) -
+                     sensor_.getConversionTimeRhum(code, true);
+    bytes += polls / Params::PARAM_TIME_POLL * Params::PARAM_BYTES_POLL;
+  }
+  uint64_t timeActive = conversionTime(code) * 1000 + busTime(bytes);
+  uint64_t timePeriod = static_cast<uint64_t>(status_.period) * 1000;
+  // Microamperes times microseconds gives picocoulombs
+  uint64_t charge = Params::PARAM_CURRENT_MAX * timeActive;
+  if (timePeriod > timeActive)
+  {
+    charge += Params::PARAM_CURRENT_SLEEP * (timePeriod - timeActive) / 100;
+  }
+  return charge / 1000;
+}
+
+uint32_t gbj_htu21_scheduler::activeTime(uint8_t code,
+                                         bool holdMasterMode,
+                                         bool useValuesTyp)
+{
+  // Library waits for maximal conversion time in hold master mode
+  useValuesTyp = useValuesTyp && !holdMasterMode;
+  uint32_t timeConversion = sensor_.getConversionTimeTemp(code, useValuesTyp) +
+                            sensor_.getConversionTimeRhum(code, useValuesTyp);
+  // Temperature and humidity conversion, one extra polling after typical time
+  uint16_t bytes = 2 * Params::PARAM_BYTES_HOLD;
+  if (useValuesTyp)
+  {
+    bytes += 2 * Params::PARAM_BYTES_POLL;
+  }
+  return timeConversion * 1000 + busTime(bytes);
+}
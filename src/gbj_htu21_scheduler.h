@@ -0,0 +1,202 @@
+/*
+  NAME:
+  gbjHTU21Scheduler
+
+  DESCRIPTION:
+  Power-aware duty-cycle scheduler of measurements with sensors HTU21D(F),
+  SHT21, SHT20, HDC1080 driven by the library gbjHTU21.
+  - The scheduler selects the finest resolution, at which the estimated
+  charge per sample fits the energy budget.
+  - The charge is estimated from datasheet currents, conversion times, and
+  number of bytes transferred on the two-wire bus.
+
+  LICENSE:
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the MIT License (MIT).
+
+  CREDENTIALS:
+  Author: Libor Gabaj
+  GitHub: https://github.com/mrkaleArduinoLib/gbj_htu21.git
+*/
+#ifndef GBJ_HTU21_SCHEDULER_H
+#define GBJ_HTU21_SCHEDULER_H
+
+#include "gbj_htu21.h"
+
+class gbj_htu21_scheduler
+{
+public:
+  typedef gbj_htu21::ResultCodes ResultCodes;
+
+  gbj_htu21_scheduler(gbj_htu21 &sensor)
+    : sensor_(sensor){};
+
+  /*
+    Initialize scheduler.
+
+    DESCRIPTION:
+    The method stores the sampling period and energy budget, selects the
+    resolution of the sensor fitting the budget, and configures the sensor
+    accordingly.
+    - The finest resolution is preferred, at which the charge per sample fits
+    the budget and maximal conversion times fit the sampling period.
+    - The measuring mode and usage of typical values are kept as set for the
+    sensor. They just determine the number of bytes on the bus.
+    - If no resolution fits the budget, the coarsest resolution is used and the
+    method returns ERROR_MEASURE.
+
+    PARAMETERS:
+    period - Sampling period in milliseconds.
+      - Data type: non-negative integer
+      - Default value: none
+      - Limited range: 0 ~ 2^32 - 1
+
+    budget - Maximal charge consumed by the sensor per sampling period in
+    nanocoulombs (microampere times millisecond).
+      - Data type: non-negative integer
+      - Default value: none
+      - Limited range: 0 ~ 2^32 - 1
+
+    RETURN: Result code
+  */
+  ResultCodes begin(uint32_t period, uint32_t budget);
+
+  /*
+    Run scheduler.
+
+    DESCRIPTION:
+    The method measures temperature and relative humidity if the sampling
+    period elapsed and accounts the charge and active time of the measurement.
+    - The method should be called in the loop of a sketch as often as
+    possible.
+
+    PARAMETERS: none
+
+    RETURN: Flag about new sample
+  */
+  bool run();
+
+  /*
+    Estimate charge per sample.
+
+    DESCRIPTION:
+    The method estimates charge consumed by the sensor during one sampling
+    period for particular configuration.
+    - The active charge consists of conversions of temperature and humidity
+    and of transferring bytes on the bus at measuring current. The sensor
+    converts for its own time regardless of the waiting of the library, so
+    that the worst case of maximal current and maximal conversion times is
+    used for all configurations.
+    - The measuring mode and usage of typical values determine just the bytes
+    on the bus. In no hold master mode with typical values the conversion is
+    polled by not acknowledged read addresses up to maximal conversion time.
+    - The sleeping charge is accounted for the rest of the sampling period.
+
+    PARAMETERS:
+    code - Resolution code (0 ~ 3) from RES1 and RES0 bits of user register.
+      - Data type: non-negative integer
+      - Default value: none
+      - Limited range: 0 ~ 3
+
+    holdMasterMode - Flag about hold master mode.
+      - Data type: bool
+      - Default value: none
+      - Limited range: true, false
+
+    useValuesTyp - Flag about waiting for typical conversion times.
+      - Data type: bool
+      - Default value: none
+      - Limited range: true, false
+
+    RETURN: Charge in nanocoulombs
+  */
+  uint32_t estimateCharge(uint8_t code, bool holdMasterMode, bool useValuesTyp);
+
+  // Getters
+  inline uint32_t getPeriod() { return status_.period; }
+  inline uint32_t getBudget() { return status_.budget; }
+  // Estimated charge per sample of selected configuration in nanocoulombs
+  inline uint32_t getChargeSample() { return status_.chargeSample; }
+  // Estimated charge of all samples since begin in microcoulombs
+  inline uint32_t getChargeTotal() { return status_.chargeTotal / 1000; }
+  inline uint32_t getSamples() { return status_.samples; }
+  // Estimated duty cycle of selected configuration in 0.01 %
+  inline uint16_t getDutyCycleEstimated()
+  {
+    return dutyCycle(activeTime(sensor_.getResolution(),
+                                sensor_.getHoldMasterMode(),
+                                sensor_.getUseValuesTyp()),
+                     static_cast<uint64_t>(status_.period) * 1000);
+  }
+  // Achieved duty cycle since begin in 0.01 %
+  inline uint16_t getDutyCycle()
+  {
+    return dutyCycle(status_.timeActive, millis() - status_.timeBegin);
+  }
+  inline float getTemperature() { return status_.temperature; }
+  inline float getHumidity() { return status_.humidity; }
+
+private:
+  enum Params : uint16_t
+  {
+    // Measuring current of the sensor in microamperes, maximal
+    PARAM_CURRENT_MAX = 500,
+    // Sleep current of the sensor in 0.01 microampere, maximal
+    PARAM_CURRENT_SLEEP = 14,
+    // Bytes per conversion in hold master mode (write address, command, read
+    // address, 2 data bytes, CRC)
+    PARAM_BYTES_HOLD = 6,
+    // Additional bytes per conversion in no hold master mode for one polling
+    // (not acknowledged read address)
+    PARAM_BYTES_POLL = 1,
+    // Polling period of conversions by the library in milliseconds
+    PARAM_TIME_POLL = 1,
+    // Bits per byte on the bus including acknowledge
+    PARAM_BITS_BYTE = 9,
+  };
+  struct Status
+  {
+    uint32_t period;
+    uint32_t budget;
+    uint32_t chargeSample;
+    // Accumulated charge in nanocoulombs
+    uint64_t chargeTotal;
+    uint32_t samples;
+    // Timestamp of recent sample in milliseconds
+    uint32_t timeSample;
+    // Timestamp of initialization in milliseconds
+    uint32_t timeBegin;
+    // Accumulated active time in milliseconds
+    uint32_t timeActive;
+    float temperature;
+    float humidity;
+  } status_;
+  gbj_htu21 &sensor_;
+
+  // Typical active time of measuring per sample in microseconds
+  uint32_t activeTime(uint8_t code, bool holdMasterMode, bool useValuesTyp);
+  // Maximal conversion time of both quantities in milliseconds
+  inline uint32_t conversionTime(uint8_t code)
+  {
+    return sensor_.getConversionTimeTemp(code, false) +
+           sensor_.getConversionTimeRhum(code, false);
+  }
+  // Bus transfer time in microseconds
+  inline uint32_t busTime(uint16_t bytes)
+  {
+    return static_cast<uint32_t>(bytes) * Params::PARAM_BITS_BYTE * 1000 /
+           (sensor_.getBusClock() / 1000);
+  }
+  // Duty cycle in 0.01 % from active time and period in the same units
+  inline uint16_t dutyCycle(uint64_t timeActive, uint64_t period)
+  {
+    if (period == 0)
+    {
+      return 0;
+    }
+    uint64_t duty = timeActive * 10000 / period;
+    return duty > 10000 ? 10000 : duty;
+  }
+};
+
+#endif
@@ -0,0 +1,45 @@
+#include "gbj_htu21_stream.h"
+
+gbj_htu21_stream::ResultCodes gbj_htu21_stream::begin()
+{
+  recoveries_ = sensor_.getRecoveries();
+  serial_ = sensor_.getSerialNumber();
+  return sensor_.getLastResult();
+}
+
+uint8_t gbj_htu21_stream::encode(uint8_t *buffer, uint8_t bufferLen)
+{
+  if (bufferLen < Frame::FRAME_SIZE)
+  {
+    return 0;
+  }
+  uint8_t idx = 0;
+  buffer[idx++] = Frame::FRAME_SYNC;
+  // Read serial number of another probe detected by a new recovery
+  if (sensor_.getRecoveries() != recoveries_)
+  {
+    recoveries_ = sensor_.getRecoveries();
+    if (sensor_.getProbeSwapped())
+    {
+      serial_ = sensor_.getSerialNumber();
+    }
+  }
+  for (int8_t i = 7; i >= 0; i--)
+  {
+    buffer[idx++] = static_cast<uint8_t>(serial_ >> (8 * i));
+  }
+  buffer[idx++] = highByte(sequence_);
+  buffer[idx++] = lowByte(sequence_);
+  uint16_t wordMeasure = sensor_.getWordTemp();
+  buffer[idx++] = highByte(wordMeasure);
+  buffer[idx++] = lowByte(wordMeasure);
+  wordMeasure = sensor_.getWordRhum();
+  buffer[idx++] = highByte(wordMeasure);
+  buffer[idx++] = lowByte(wordMeasure);
+  // Stale flag covers both quantities of the recent measurement
+  buffer[idx++] =
+    sensor_.getResolution() | (sensor_.getStale() ? Frame::FRAME_STALE : 0);
+  buffer[idx] = sensor_.calculateCrc8(buffer, idx);
+  sequence_++;
+  return ++idx;
+}
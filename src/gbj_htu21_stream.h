@@ -0,0 +1,110 @@
+/*
+  NAME:
+  gbjHTU21Stream
+
+  DESCRIPTION:
+  Streaming encoder of samples measured with sensors HTU21D(F), SHT21, SHT20,
+  HDC1080 driven by the library gbjHTU21 to fixed-size binary frames.
+  - The encoder writes frames into a buffer provided by a caller without any
+  memory allocation and floating point formatting.
+  - Frame layout in big endian byte order (17 bytes):
+    - 1 byte: synchronization byte 0xA5
+    - 8 bytes: serial number of the sensor
+    - 2 bytes: sequence number of the frame
+    - 2 bytes: binary word of temperature without status bits
+    - 2 bytes: binary word of relative humidity without status bits
+    - 1 byte: resolution code (bits 0, 1), stale flag (bit 7) of any quantity
+    - 1 byte: CRC8 of all preceding bytes of the frame (sensor's polynom)
+
+  LICENSE:
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the MIT License (MIT).
+
+  CREDENTIALS:
+  Author: Libor Gabaj
+  GitHub: https://github.com/mrkaleArduinoLib/gbj_htu21.git
+*/
+#ifndef GBJ_HTU21_STREAM_H
+#define GBJ_HTU21_STREAM_H
+
+#include "gbj_htu21.h"
+
+class gbj_htu21_stream
+{
+public:
+  typedef gbj_htu21::ResultCodes ResultCodes;
+
+  enum Frame : uint8_t
+  {
+    // Synchronization byte at the frame start
+    FRAME_SYNC = 0xA5,
+    // Size of the frame in bytes
+    FRAME_SIZE = 17,
+    // Flag about stale measured values in the resolution byte
+    FRAME_STALE = 0x80,
+  };
+
+  gbj_htu21_stream(gbj_htu21 &sensor)
+    : sensor_(sensor)
+    , sequence_(0)
+    , serial_(0)
+    , recoveries_(0){};
+
+  /*
+    Initialize encoder.
+
+    DESCRIPTION:
+    The method reads the serial number of the initialized sensor and keeps it
+    for all frames, so that encoding does not communicate on the bus.
+    - The serial number is read again only after the sensor reports a swapped
+    probe at its recovery.
+
+    PARAMETERS: none
+
+    RETURN: Result code of reading the serial number
+  */
+  ResultCodes begin();
+
+  /*
+    Encode recent sample.
+
+    DESCRIPTION:
+    The method encodes recent valid binary words of temperature and relative
+    humidity measured by the sensor to a frame and increments the sequence
+    number.
+    - The stale flag is set if any of both quantities of the recent
+    measurement has been substituted by its recent valid value.
+
+    PARAMETERS:
+    buffer - Pointer to a buffer for the frame.
+      - Data type: pointer
+      - Default value: none
+      - Limited range: none
+
+    bufferLen - Size of the buffer in bytes.
+      - Data type: non-negative integer
+      - Default value: none
+      - Limited range: 0 ~ 255
+
+    RETURN: Number of bytes written to the buffer or zero if the buffer is too
+    small
+  */
+  uint8_t encode(uint8_t *buffer, uint8_t bufferLen);
+
+  // Setters
+  inline void setSequence(uint16_t sequence) { sequence_ = sequence; }
+
+  // Getters
+  inline uint16_t getSequence() { return sequence_; }
+
+private:
+  gbj_htu21 &sensor_;
+  // Sequence number of the next frame
+  uint16_t sequence_;
+  // Serial number of the sensor read at begin or after swapping a probe
+  uint64_t serial_;
+  // Number of recoveries of the sensor at recent check of swapping
+  uint16_t recoveries_;
+};
+
+#endif